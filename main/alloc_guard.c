@@ -0,0 +1,91 @@
+#include "alloc_guard.h"
+
+#include <assert.h>
+
+#include "esp_attr.h"  // For IRAM_ATTR
+#include "sdkconfig.h"
+
+#if CONFIG_VBAN_ALLOC_GUARD
+
+#include "esp_heap_caps.h"  // For esp_heap_trace_alloc_hook
+
+static TaskHandle_t s_tasks[ALLOC_GUARD_MAX_TASKS];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;  // Serializes changes of s_tasks (the hook reads without it)
+static volatile bool s_armed = false;
+static volatile uint32_t s_violations = 0;
+
+esp_err_t alloc_guard_watch_task(TaskHandle_t task) {
+  if (!task) {
+    task = xTaskGetCurrentTaskHandle();
+  }
+
+  size_t free_index = ALLOC_GUARD_MAX_TASKS;
+  portENTER_CRITICAL(&s_lock);
+  for (size_t i = 0; i < ALLOC_GUARD_MAX_TASKS; i++) {
+    if (s_tasks[i] == task) {
+      portEXIT_CRITICAL(&s_lock);
+      return ESP_OK;
+    }
+    if (!s_tasks[i] && free_index == ALLOC_GUARD_MAX_TASKS) {
+      free_index = i;
+    }
+  }
+  if (free_index < ALLOC_GUARD_MAX_TASKS) {
+    s_tasks[free_index] = task;
+  }
+  portEXIT_CRITICAL(&s_lock);
+  return free_index < ALLOC_GUARD_MAX_TASKS ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void alloc_guard_unwatch_task(TaskHandle_t task) {
+  if (!task) {
+    task = xTaskGetCurrentTaskHandle();
+  }
+
+  portENTER_CRITICAL(&s_lock);
+  for (size_t i = 0; i < ALLOC_GUARD_MAX_TASKS; i++) {
+    if (s_tasks[i] == task) {
+      s_tasks[i] = NULL;
+    }
+  }
+  portEXIT_CRITICAL(&s_lock);
+}
+
+void alloc_guard_arm(bool armed) { s_armed = armed; }
+
+uint32_t alloc_guard_get_violations(void) { return s_violations; }
+
+// Called by the heap component after every successful allocation (CONFIG_HEAP_USE_HOOKS).
+// Allocations may happen with the cache disabled, hence IRAM.
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) {
+  (void)ptr;
+  (void)size;
+  (void)caps;
+  if (!s_armed || xPortInIsrContext()) {
+    return;
+  }
+
+  TaskHandle_t current = xTaskGetCurrentTaskHandle();
+  for (size_t i = 0; i < ALLOC_GUARD_MAX_TASKS; i++) {
+    if (s_tasks[i] == current) {
+      s_violations++;
+      assert(!"Heap allocation in a streaming task");
+      return;
+    }
+  }
+}
+
+#else  // CONFIG_VBAN_ALLOC_GUARD
+
+esp_err_t alloc_guard_watch_task(TaskHandle_t task) {
+  (void)task;
+  return ESP_OK;
+}
+
+void alloc_guard_unwatch_task(TaskHandle_t task) { (void)task; }
+
+void alloc_guard_arm(bool armed) { (void)armed; }
+
+uint32_t alloc_guard_get_violations(void) { return 0; }
+
+#endif  // CONFIG_VBAN_ALLOC_GUARD
@@ -0,0 +1,61 @@
+#ifndef ALLOC_GUARD_H_
+#define ALLOC_GUARD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"  // For TaskHandle_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALLOC_GUARD_MAX_TASKS 8  // Max tasks watched at the same time
+
+/**
+ * Heap allocation guard (debug aid, enabled with CONFIG_VBAN_ALLOC_GUARD)
+ *
+ * Streaming tasks are expected to run without touching the heap once set up. The guard watches a set of
+ * tasks through the heap allocation hook; once armed, every heap allocation made by a watched task is counted
+ * and fails an assertion (unless NDEBUG is defined). Without CONFIG_VBAN_ALLOC_GUARD all functions are no-ops.
+ */
+
+/**
+ * @brief Watch a task
+ *
+ * @param task Task to watch (NULL for the calling task)
+ * @return
+ * - ESP_OK: Success (also when the guard is disabled)
+ * - ESP_ERR_NO_MEM: ALLOC_GUARD_MAX_TASKS tasks are already watched
+ */
+esp_err_t alloc_guard_watch_task(TaskHandle_t task);
+
+/**
+ * @brief Stop watching a task (unknown tasks are ignored)
+ *
+ * @param task Task to stop watching (NULL for the calling task)
+ */
+void alloc_guard_unwatch_task(TaskHandle_t task);
+
+/**
+ * @brief Arm or disarm the guard
+ * Arm it once streaming has started, i.e. after every pipeline object has been created.
+ *
+ * @param armed true to report allocations of watched tasks from now on
+ */
+void alloc_guard_arm(bool armed);
+
+/**
+ * @brief Get the number of heap allocations made by watched tasks while the guard was armed
+ *
+ * @return Number of violations (always 0 when the guard is disabled)
+ */
+uint32_t alloc_guard_get_violations(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ALLOC_GUARD_H_
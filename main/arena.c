@@ -0,0 +1,72 @@
+#include "arena.h"
+
+#include <string.h>  // For memset
+
+#include "esp_heap_caps.h"
+
+esp_err_t arena_init(arena_t *arena, void *memory, size_t capacity) {
+  if (!arena || capacity == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(arena, 0, sizeof(*arena));
+  if (!memory) {
+    arena->allocation = heap_caps_malloc(capacity, ARENA_HEAP_CAPS);
+    if (!arena->allocation) {
+      return ESP_ERR_NO_MEM;
+    }
+    memory = arena->allocation;
+  }
+  arena->base = (uint8_t *)memory;
+  arena->capacity = capacity;
+  portMUX_INITIALIZE(&arena->lock);
+  return ESP_OK;
+}
+
+void arena_deinit(arena_t *arena) {
+  if (!arena) {
+    return;
+  }
+
+  heap_caps_free(arena->allocation);
+  arena->allocation = NULL;
+  arena->base = NULL;
+  arena->capacity = 0;
+  arena->used = 0;
+}
+
+void *arena_alloc(arena_t *arena, size_t size, size_t alignment) {
+  if (!arena || !arena->base) {
+    return NULL;
+  }
+  if (alignment < ARENA_MIN_ALIGNMENT) {
+    alignment = ARENA_MIN_ALIGNMENT;
+  }
+
+  // Align the address rather than the offset, so caller-supplied memory may start anywhere
+  void *ptr = NULL;
+  portENTER_CRITICAL(&arena->lock);
+  uintptr_t start = ((uintptr_t)arena->base + arena->used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+  size_t offset = start - (uintptr_t)arena->base;
+  if (offset <= arena->capacity && size <= arena->capacity - offset) {
+    ptr = (void *)start;
+    arena->used = offset + size;
+  }
+  portEXIT_CRITICAL(&arena->lock);
+
+  if (ptr) {
+    memset(ptr, 0, size);
+  }
+  return ptr;
+}
+
+size_t arena_get_used(arena_t *arena) {
+  if (!arena) {
+    return 0;
+  }
+
+  portENTER_CRITICAL(&arena->lock);
+  size_t used = arena->used;
+  portEXIT_CRITICAL(&arena->lock);
+  return used;
+}
@@ -0,0 +1,80 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_heap_caps.h"      // For MALLOC_CAP_*
+#include "freertos/FreeRTOS.h"  // For portMUX_TYPE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARENA_MIN_ALIGNMENT 8  // Alignment of every allocation unless a larger one is requested
+// Capabilities of the block allocated by arena_init(): internal RAM, so task stacks can be carved from it (buffers
+// that must be DMA-capable are allocated on their own, see vban_dma_ring_init())
+#define ARENA_HEAP_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+/**
+ * @brief Bump allocator over one block of memory
+ *
+ * Objects are carved from the block at setup time and are never freed individually; the whole block is
+ * released at once by arena_deinit(). Users sized from one arena therefore neither fragment the heap nor
+ * touch it after setup, and their total footprint is known up front. Allocation is safe from any task.
+ */
+typedef struct {
+  uint8_t *base;      /**< Start of the usable memory */
+  size_t capacity;    /**< Size of the usable memory in bytes */
+  size_t used;        /**< Bytes handed out so far, alignment padding included */
+  void *allocation;   /**< Heap block allocated by arena_init() (NULL for caller-supplied memory) */
+  portMUX_TYPE lock;  /**< Protects used */
+} arena_t;
+
+/**
+ * @brief Initialize an arena
+ *
+ * @param arena Pointer to the arena structure
+ * @param memory Memory to carve from (at least capacity bytes, owned by the caller), or NULL to allocate
+ *               capacity bytes with ARENA_HEAP_CAPS in one block
+ * @param capacity Size of the arena in bytes
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL arena or zero capacity
+ * - ESP_ERR_NO_MEM: The block could not be allocated
+ */
+esp_err_t arena_init(arena_t *arena, void *memory, size_t capacity);
+
+/**
+ * @brief Release the arena
+ * Memory allocated by arena_init() is freed; everything carved from the arena becomes invalid.
+ *
+ * @param arena Pointer to the arena structure
+ */
+void arena_deinit(arena_t *arena);
+
+/**
+ * @brief Carve zeroed memory from the arena
+ *
+ * @param arena Pointer to the arena structure
+ * @param size Number of bytes
+ * @param alignment Required alignment (power of two, raised to ARENA_MIN_ALIGNMENT)
+ * @return Pointer to the memory, or NULL if the arena is exhausted
+ */
+void *arena_alloc(arena_t *arena, size_t size, size_t alignment);
+
+/**
+ * @brief Get the number of bytes carved from the arena so far
+ * Useful to size the arena: run the application once with a generous capacity and read this after setup.
+ *
+ * @param arena Pointer to the arena structure
+ * @return Bytes used, alignment padding included
+ */
+size_t arena_get_used(arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ARENA_H_
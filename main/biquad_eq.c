@@ -0,0 +1,155 @@
+#include "biquad_eq.h"
+
+#include <math.h>    // For cosf, sinf, powf, sqrtf
+#include <string.h>  // For memset
+
+#include "hot_path.h"
+
+#if __has_include("dsps_biquad.h")
+#include "dsps_biquad.h"  // Optimized kernels of the espressif/esp-dsp component (see idf_component.yml)
+#define BIQUAD_EQ_ESP_DSP 1
+#else
+#define BIQUAD_EQ_ESP_DSP 0
+#endif
+
+#define BIQUAD_EQ_FRESH 0x4u  // Flag of published: the bank has not been taken by the audio task yet
+#define BIQUAD_EQ_INDEX 0x3u  // Bank index in published
+
+esp_err_t biquad_design(biquad_type_t type, float sample_rate, float freq, float q, float gain_db, biquad_coeffs_t *coeffs) {
+  if (!coeffs || sample_rate <= 0.0f || freq <= 0.0f || freq >= sample_rate / 2 || q <= 0.0f) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  const float w0 = 2.0f * (float)M_PI * freq / sample_rate;
+  const float cos_w0 = cosf(w0);
+  const float alpha = sinf(w0) / (2.0f * q);
+  const float a = powf(10.0f, gain_db / 40.0f);
+  float b0, b1, b2, a0, a1, a2;
+  switch (type) {
+    case BIQUAD_PEAKING:
+      b0 = 1.0f + alpha * a;
+      b1 = -2.0f * cos_w0;
+      b2 = 1.0f - alpha * a;
+      a0 = 1.0f + alpha / a;
+      a1 = -2.0f * cos_w0;
+      a2 = 1.0f - alpha / a;
+      break;
+    case BIQUAD_LOW_SHELF:
+    case BIQUAD_HIGH_SHELF: {
+      const float s = type == BIQUAD_LOW_SHELF ? 1.0f : -1.0f;  // The high shelf mirrors the signs of the cos terms
+      const float k = 2.0f * sqrtf(a) * alpha;
+      b0 = a * ((a + 1.0f) - s * (a - 1.0f) * cos_w0 + k);
+      b1 = s * 2.0f * a * ((a - 1.0f) - s * (a + 1.0f) * cos_w0);
+      b2 = a * ((a + 1.0f) - s * (a - 1.0f) * cos_w0 - k);
+      a0 = (a + 1.0f) + s * (a - 1.0f) * cos_w0 + k;
+      a1 = -s * 2.0f * ((a - 1.0f) + s * (a + 1.0f) * cos_w0);
+      a2 = (a + 1.0f) + s * (a - 1.0f) * cos_w0 - k;
+      break;
+    }
+    case BIQUAD_LOW_PASS:
+      b1 = 1.0f - cos_w0;
+      b0 = b1 / 2.0f;
+      b2 = b0;
+      a0 = 1.0f + alpha;
+      a1 = -2.0f * cos_w0;
+      a2 = 1.0f - alpha;
+      break;
+    case BIQUAD_HIGH_PASS:
+      b1 = -(1.0f + cos_w0);
+      b0 = -b1 / 2.0f;
+      b2 = b0;
+      a0 = 1.0f + alpha;
+      a1 = -2.0f * cos_w0;
+      a2 = 1.0f - alpha;
+      break;
+    default:
+      return ESP_ERR_INVALID_ARG;
+  }
+  coeffs->b0 = b0 / a0;
+  coeffs->b1 = b1 / a0;
+  coeffs->b2 = b2 / a0;
+  coeffs->a1 = a1 / a0;
+  coeffs->a2 = a2 / a0;
+  return ESP_OK;
+}
+
+esp_err_t biquad_eq_init(biquad_eq_t *eq, size_t num_channels) {
+  if (!eq || num_channels == 0 || num_channels > BIQUAD_EQ_MAX_CHANNELS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(eq, 0, sizeof(*eq));
+  eq->num_channels = num_channels;
+  eq->front = 0;
+  atomic_init(&eq->published, 1);
+  eq->back = 2;
+  return ESP_OK;
+}
+
+esp_err_t biquad_eq_set_sections(biquad_eq_t *eq, int channel, const biquad_coeffs_t *coeffs, size_t num_sections) {
+  if (!eq || (!coeffs && num_sections > 0) || num_sections > BIQUAD_EQ_MAX_SECTIONS || channel < -1 ||
+      channel >= (int)eq->num_channels) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  for (size_t c = 0; c < eq->num_channels; c++) {
+    if (channel < 0 || (size_t)channel == c) {
+      memcpy(eq->staging.coeffs[c], coeffs, num_sections * sizeof(biquad_coeffs_t));
+      eq->staging.num_sections[c] = (uint8_t)num_sections;
+    }
+  }
+  // Fill the spare bank and swap it in; the bank handed back is the new spare (the audio task never holds it)
+  eq->banks[eq->back] = eq->staging;
+  const unsigned previous = atomic_exchange_explicit(&eq->published, eq->back | BIQUAD_EQ_FRESH, memory_order_acq_rel);
+  eq->back = previous & BIQUAD_EQ_INDEX;
+  return ESP_OK;
+}
+
+// Transposed direct form II over a whole block, one section at a time: the coefficients and the two state values
+// stay in registers for the whole pass.
+static inline __attribute__((always_inline)) void biquad_eq_section(const biquad_coeffs_t *c, float *z, float *x, size_t frames,
+                                                                     size_t stride) {
+  const float b0 = c->b0, b1 = c->b1, b2 = c->b2, a1 = c->a1, a2 = c->a2;
+  float z1 = z[0], z2 = z[1];
+  for (size_t f = 0; f < frames; f++, x += stride) {
+    const float in = *x;
+    const float out = b0 * in + z1;
+    z1 = b1 * in - a1 * out + z2;
+    z2 = b2 * in - a2 * out;
+    *x = out;
+  }
+  z[0] = z1;
+  z[1] = z2;
+}
+
+HOT_PATH_ATTR void biquad_eq_process(biquad_eq_t *eq, float *samples, size_t frames) {
+  // Take the latest published bank, if any; sections that were not running before start from silence
+  if (atomic_load_explicit(&eq->published, memory_order_relaxed) & BIQUAD_EQ_FRESH) {
+    // The exchange hands the running bank back to the control task, which may refill it at once: read its section
+    // counts before
+    uint8_t running[BIQUAD_EQ_MAX_CHANNELS];
+    memcpy(running, eq->banks[eq->front].num_sections, sizeof(running));
+    eq->front = atomic_exchange_explicit(&eq->published, eq->front, memory_order_acq_rel) & BIQUAD_EQ_INDEX;
+    for (size_t c = 0; c < eq->num_channels; c++) {
+      if (eq->banks[eq->front].num_sections[c] > running[c]) {
+        memset(eq->state[c][running[c]], 0, (eq->banks[eq->front].num_sections[c] - running[c]) * sizeof(eq->state[c][0]));
+      }
+    }
+  }
+
+  const biquad_eq_bank_t *bank = &eq->banks[eq->front];
+  const size_t channels = eq->num_channels;
+#if BIQUAD_EQ_ESP_DSP
+  if (channels == 1) {
+    for (size_t s = 0; s < bank->num_sections[0]; s++) {
+      dsps_biquad_f32(samples, samples, (int)frames, (float *)&bank->coeffs[0][s], eq->state[0][s]);
+    }
+    return;
+  }
+#endif
+  for (size_t c = 0; c < channels; c++) {
+    for (size_t s = 0; s < bank->num_sections[c]; s++) {
+      biquad_eq_section(&bank->coeffs[c][s], eq->state[c][s], samples + c, frames, channels);
+    }
+  }
+}
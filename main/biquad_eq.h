@@ -0,0 +1,118 @@
+#ifndef BIQUAD_EQ_H_
+#define BIQUAD_EQ_H_
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BIQUAD_EQ_MAX_SECTIONS 10  // Biquad sections per channel
+#define BIQUAD_EQ_MAX_CHANNELS 2   // Interleaved channels of one equalizer
+
+/**
+ * @brief Filter shapes of biquad_design() (RBJ audio EQ cookbook)
+ */
+typedef enum {
+  BIQUAD_PEAKING,     /**< Bell around freq, gain_db at the center, width from q */
+  BIQUAD_LOW_SHELF,   /**< gain_db below freq */
+  BIQUAD_HIGH_SHELF,  /**< gain_db above freq */
+  BIQUAD_LOW_PASS,    /**< Second-order low-pass (gain_db unused) */
+  BIQUAD_HIGH_PASS,   /**< Second-order high-pass (gain_db unused) */
+} biquad_type_t;
+
+/**
+ * @brief Coefficients of one section, normalized to a0 = 1
+ * y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]. The layout is that of ESP-DSP's coefficient arrays.
+ */
+typedef struct {
+  float b0, b1, b2, a1, a2;
+} biquad_coeffs_t;
+
+/**
+ * @brief One set of coefficients for every channel
+ */
+typedef struct {
+  biquad_coeffs_t coeffs[BIQUAD_EQ_MAX_CHANNELS][BIQUAD_EQ_MAX_SECTIONS];  /**< Sections of each channel, in order */
+  uint8_t num_sections[BIQUAD_EQ_MAX_CHANNELS];                            /**< Active sections of each channel */
+} biquad_eq_bank_t;
+
+/**
+ * @brief Cascaded biquad equalizer processing float blocks in place
+ *
+ * The audio task runs biquad_eq_process() on whole blocks: each section makes one pass over the block with its
+ * coefficients and state in registers. A control task changes the coefficients at any time without locks: it
+ * writes a spare bank and swaps it in with one atomic exchange (triple buffering), and the audio task picks up
+ * the latest bank at the start of its next block. Neither side ever waits for the other. All memory is part of
+ * the structure.
+ */
+typedef struct {
+  size_t num_channels;                                             /**< Interleaved channels of the blocks */
+  biquad_eq_bank_t banks[3];                                       /**< Front, published and back bank (see above) */
+  atomic_uint published;                                           /**< Published bank, flagged until the audio task takes it */
+  unsigned front;                                                  /**< Bank used by the audio task */
+  unsigned back;                                                   /**< Bank written by the control task */
+  biquad_eq_bank_t staging;                                        /**< Settings of the control task, copied to back */
+  float state[BIQUAD_EQ_MAX_CHANNELS][BIQUAD_EQ_MAX_SECTIONS][2];  /**< Delay line of each section */
+} biquad_eq_t;
+
+/**
+ * @brief Compute the coefficients of one section
+ *
+ * @param type Filter shape
+ * @param sample_rate Sample rate in Hz
+ * @param freq Center, corner or shelf frequency in Hz (below sample_rate / 2)
+ * @param q Quality factor (e.g. 0.707 for a Butterworth pass filter or a gentle shelf)
+ * @param gain_db Gain of peaking and shelf filters in dB
+ * @param[out] coeffs Receives the coefficients
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL coeffs, unknown type, or frequency or q out of range
+ */
+esp_err_t biquad_design(biquad_type_t type, float sample_rate, float freq, float q, float gain_db, biquad_coeffs_t *coeffs);
+
+/**
+ * @brief Initialize an equalizer without sections (blocks pass unchanged)
+ *
+ * @param eq Pointer to the equalizer structure
+ * @param num_channels Interleaved channels (1 to BIQUAD_EQ_MAX_CHANNELS)
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL eq or unsupported channel count
+ */
+esp_err_t biquad_eq_init(biquad_eq_t *eq, size_t num_channels);
+
+/**
+ * @brief Replace the sections of a channel (control task, lock-free)
+ * Takes effect from the next block processed. Call from one control task at a time.
+ *
+ * @param eq Pointer to the equalizer structure
+ * @param channel Channel to change, or -1 for every channel
+ * @param coeffs Sections in processing order
+ * @param num_sections Number of sections (0 to BIQUAD_EQ_MAX_SECTIONS, 0 to bypass)
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer, unknown channel or too many sections
+ */
+esp_err_t biquad_eq_set_sections(biquad_eq_t *eq, int channel, const biquad_coeffs_t *coeffs, size_t num_sections);
+
+/**
+ * @brief Filter a block of interleaved float samples in place (audio task)
+ * Mono equalizers run the optimized biquad kernel of ESP-DSP (the espressif/esp-dsp component the project depends
+ * on); equalizers of several channels, and builds without the component, run the portable kernel.
+ *
+ * @param eq Pointer to the equalizer structure
+ * @param samples frames * num_channels samples
+ * @param frames Number of frames
+ */
+void biquad_eq_process(biquad_eq_t *eq, float *samples, size_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // BIQUAD_EQ_H_
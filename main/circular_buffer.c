@@ -3,6 +3,8 @@
 #include <stdlib.h>  // For malloc, free
 #include <string.h>  // For memcpy
 
+#include "hot_path.h"
+
 // --- Helper Macros for precondition checking ---
 #define CB_ENSURE_VALID_CB_PTR(cb_ptr) \
   if (!(cb_ptr)) return CB_ERROR_INVALID_ARG;
@@ -28,13 +30,32 @@ int circular_buffer_init(circular_buffer_t *cb, size_t capacity) {
   cb->tail = 0;
   cb->count = 0;
   cb->is_initialized = true;
+  cb->owns_buffer = true;
+
+  return CB_SUCCESS;
+}
+
+int circular_buffer_init_with_storage(circular_buffer_t *cb, void *storage, size_t capacity) {
+  if (!cb || !storage || capacity == 0) {
+    return CB_ERROR_INVALID_ARG;
+  }
+
+  cb->buffer = (char *)storage;
+  cb->capacity = capacity;
+  cb->head = 0;
+  cb->tail = 0;
+  cb->count = 0;
+  cb->is_initialized = true;
+  cb->owns_buffer = false;
 
   return CB_SUCCESS;
 }
 
 void circular_buffer_destroy(circular_buffer_t *cb) {
   if (cb && cb->is_initialized) {
-    free(cb->buffer);
+    if (cb->owns_buffer) {
+      free(cb->buffer);
+    }
     cb->buffer = NULL;  // Set to NULL after freeing
     cb->capacity = 0;
     cb->head = 0;
@@ -44,7 +65,7 @@ void circular_buffer_destroy(circular_buffer_t *cb) {
   }
 }
 
-int circular_buffer_write(circular_buffer_t *cb, const void *data, size_t bytes) {
+HOT_PATH_ATTR int circular_buffer_write(circular_buffer_t *cb, const void *data, size_t bytes) {
   CB_ENSURE_INITIALIZED(cb);
 
   if (!data && bytes > 0) {  // data is NULL even though bytes > 0 is invalid
@@ -61,16 +82,19 @@ int circular_buffer_write(circular_buffer_t *cb, const void *data, size_t bytes)
   const char *data_char = (const char *)data;
   size_t current_logical_head = cb->head;
 
-  // Copy data into two regions
+  // Copy data into two regions. A byte is mirrored only if it lands before tail: only then can a readable region,
+  // which starts at tail and runs past the end of the logical buffer, reach its mirror
   // 1. From head to the end of the logical buffer
   size_t len_part1 = cb->capacity - current_logical_head;
   if (len_part1 > bytes) {
     len_part1 = bytes;
   }
   memcpy(cb->buffer + current_logical_head, data_char, len_part1);
-  memcpy(cb->buffer + current_logical_head + cb->capacity, data_char, len_part1);  // Mirror region
+  if (current_logical_head < cb->tail) {
+    memcpy(cb->buffer + current_logical_head + cb->capacity, data_char, len_part1);  // Mirror region
+  }
 
-  // 2. From the beginning of the logical buffer for the remainder (if wrap-around occurs)
+  // 2. From the beginning of the logical buffer for the remainder (if wrap-around occurs), always before tail
   size_t remaining_bytes = bytes - len_part1;
   if (remaining_bytes > 0) {
     memcpy(cb->buffer, data_char + len_part1, remaining_bytes);
@@ -83,7 +107,55 @@ int circular_buffer_write(circular_buffer_t *cb, const void *data, size_t bytes)
   return CB_SUCCESS;
 }
 
-void *circular_buffer_get_readable_region(circular_buffer_t *cb, size_t *readable_bytes) {
+HOT_PATH_ATTR void *circular_buffer_get_writable_region(circular_buffer_t *cb, size_t *writable_bytes) {
+  if (!writable_bytes) {  // Output pointer is NULL
+    return NULL;
+  }
+  if (!cb || !cb->is_initialized || cb->count == cb->capacity) {  // Invalid, uninitialized or full
+    *writable_bytes = 0;
+    return NULL;
+  }
+
+  // The region from head up to the free space is contiguous because the internal buffer is twice the capacity
+  *writable_bytes = cb->capacity - cb->count;
+  return (void *)(cb->buffer + cb->head);
+}
+
+HOT_PATH_ATTR int circular_buffer_commit(circular_buffer_t *cb, size_t bytes_written) {
+  CB_ENSURE_INITIALIZED(cb);
+
+  if (bytes_written == 0) {  // If there is no data to commit, succeed
+    return CB_SUCCESS;
+  }
+  if (bytes_written > circular_buffer_get_free_space(cb)) {
+    return CB_ERROR_BUFFER_FULL;
+  }
+
+  size_t current_logical_head = cb->head;
+
+  // 1. Bytes written in the primary region are mirrored to the upper half if they are before tail (as in
+  // circular_buffer_write(); otherwise no reader reaches their mirror)
+  size_t len_part1 = cb->capacity - current_logical_head;
+  if (len_part1 > bytes_written) {
+    len_part1 = bytes_written;
+  }
+  if (current_logical_head < cb->tail) {
+    memcpy(cb->buffer + current_logical_head + cb->capacity, cb->buffer + current_logical_head, len_part1);
+  }
+
+  // 2. Bytes that spilled into the upper half are mirrored back to the beginning of the primary region
+  size_t remaining_bytes = bytes_written - len_part1;
+  if (remaining_bytes > 0) {
+    memcpy(cb->buffer, cb->buffer + cb->capacity, remaining_bytes);
+  }
+
+  cb->head = (current_logical_head + bytes_written) % cb->capacity;
+  cb->count += bytes_written;
+
+  return CB_SUCCESS;
+}
+
+HOT_PATH_ATTR void *circular_buffer_get_readable_region(circular_buffer_t *cb, size_t *readable_bytes) {
   if (!readable_bytes) {  // Output pointer is NULL
     return NULL;
   }
@@ -106,7 +178,7 @@ void *circular_buffer_get_readable_region(circular_buffer_t *cb, size_t *readabl
   return (void *)(cb->buffer + cb->tail);
 }
 
-int circular_buffer_consume(circular_buffer_t *cb, size_t bytes_consumed) {
+HOT_PATH_ATTR int circular_buffer_consume(circular_buffer_t *cb, size_t bytes_consumed) {
   CB_ENSURE_INITIALIZED(cb);
 
   if (bytes_consumed == 0) {  // If there is no data to consume, succeed
@@ -123,35 +195,35 @@ int circular_buffer_consume(circular_buffer_t *cb, size_t bytes_consumed) {
   return CB_SUCCESS;
 }
 
-size_t circular_buffer_get_count(const circular_buffer_t *cb) {
+HOT_PATH_ATTR size_t circular_buffer_get_count(const circular_buffer_t *cb) {
   if (!cb || !cb->is_initialized) {
     return 0;
   }
   return cb->count;
 }
 
-size_t circular_buffer_get_capacity(const circular_buffer_t *cb) {
+HOT_PATH_ATTR size_t circular_buffer_get_capacity(const circular_buffer_t *cb) {
   if (!cb || !cb->is_initialized) {
     return 0;
   }
   return cb->capacity;
 }
 
-size_t circular_buffer_get_free_space(const circular_buffer_t *cb) {
+HOT_PATH_ATTR size_t circular_buffer_get_free_space(const circular_buffer_t *cb) {
   if (!cb || !cb->is_initialized) {
     return 0;
   }
   return cb->capacity - cb->count;
 }
 
-bool circular_buffer_is_empty(const circular_buffer_t *cb) {
+HOT_PATH_ATTR bool circular_buffer_is_empty(const circular_buffer_t *cb) {
   if (!cb || !cb->is_initialized) {
     return true;  // Consider uninitialized etc. as empty
   }
   return cb->count == 0;
 }
 
-bool circular_buffer_is_full(const circular_buffer_t *cb) {
+HOT_PATH_ATTR bool circular_buffer_is_full(const circular_buffer_t *cb) {
   if (!cb || !cb->is_initialized) {
     return false;  // Consider uninitialized etc. as not full
   }
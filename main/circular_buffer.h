@@ -16,12 +16,13 @@
  * @brief Circular buffer structure
  */
 typedef struct {
-  char *buffer;        /**< Internal data buffer (actual size is capacity * 2) */
-  size_t capacity;     /**< Logical buffer capacity (user-specified size) */
-  size_t head;         /**< Logical index of write position (0 to capacity-1) */
-  size_t tail;         /**< Logical index of read position (0 to capacity-1) */
-  size_t count;        /**< Number of bytes currently stored in the buffer */
-  bool is_initialized; /**< Initialization flag */
+  char *buffer;         /**< Internal data buffer (actual size is capacity * 2) */
+  size_t capacity;      /**< Logical buffer capacity (user-specified size) */
+  size_t head;          /**< Logical index of write position (0 to capacity-1) */
+  size_t tail;          /**< Logical index of read position (0 to capacity-1) */
+  size_t count;         /**< Number of bytes currently stored in the buffer */
+  bool is_initialized;  /**< Initialization flag */
+  bool owns_buffer;     /**< buffer was allocated by circular_buffer_init() and is freed on destroy */
 } circular_buffer_t;
 
 /**
@@ -34,7 +35,18 @@ typedef struct {
 int circular_buffer_init(circular_buffer_t *cb, size_t capacity);
 
 /**
- * @brief Destroy the circular buffer and free allocated memory
+ * @brief Initialize the circular buffer on caller-supplied memory
+ * The memory is not freed by circular_buffer_destroy().
+ *
+ * @param cb Pointer to the circular buffer structure
+ * @param storage Memory for the internal buffer (at least capacity * 2 bytes)
+ * @param capacity Buffer logical capacity (in bytes)
+ * @return CB_SUCCESS on success, negative error code on failure
+ */
+int circular_buffer_init_with_storage(circular_buffer_t *cb, void *storage, size_t capacity);
+
+/**
+ * @brief Destroy the circular buffer and free allocated memory (if allocated by circular_buffer_init())
  *
  * @param cb Pointer to the circular buffer structure
  */
@@ -42,8 +54,9 @@ void circular_buffer_destroy(circular_buffer_t *cb);
 
 /**
  * @brief Write data to the circular buffer
- * The data is copied into the internal buffer.
- * Internally, the data is copied to two locations for mirroring.
+ * The data is copied into the internal buffer. Bytes that a readable region can reach through the mirror (those
+ * written after a wrap-around, while buffered data still runs to the end of the buffer) are copied a second time
+ * into the mirror region; the others are copied once.
  *
  * @param cb Pointer to the circular buffer structure
  * @param data Pointer to the data to write
@@ -52,6 +65,29 @@ void circular_buffer_destroy(circular_buffer_t *cb);
  */
 int circular_buffer_write(circular_buffer_t *cb, const void *data, size_t bytes);
 
+/**
+ * @brief Get a pointer to a contiguous writable region
+ * Data can be produced directly into this region (e.g. by a format converter) and published
+ * with circular_buffer_commit(), avoiding a staging copy.
+ * This function does not modify the buffer state (does not advance the write position).
+ *
+ * @param cb Pointer to the circular buffer structure
+ * @param[out] writable_bytes Pointer to store the number of writable contiguous bytes (equal to the free space)
+ * @return Pointer to the writable region. Returns NULL on error or if the buffer is full.
+ */
+void *circular_buffer_get_writable_region(circular_buffer_t *cb, size_t *writable_bytes);
+
+/**
+ * @brief Commit data written into the region returned by circular_buffer_get_writable_region()
+ * The committed bytes that a readable region can reach through the mirror are copied to the mirror region (see
+ * circular_buffer_write()), and the write position is advanced.
+ *
+ * @param cb Pointer to the circular buffer structure
+ * @param bytes_written Number of bytes written into the writable region
+ * @return CB_SUCCESS on success, negative error code on failure
+ */
+int circular_buffer_commit(circular_buffer_t *cb, size_t bytes_written);
+
 /**
  * @brief Get a pointer to a contiguous readable data region
  * This function does not modify the buffer state (does not advance the read position).
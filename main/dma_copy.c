@@ -0,0 +1,85 @@
+#include "dma_copy.h"
+
+#include <stdint.h>
+#include <string.h>  // For memcpy
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "hot_path.h"
+#include "sdkconfig.h"
+
+#if CONFIG_VBAN_DMA_COPY
+
+#include "esp_async_memcpy.h"
+#include "esp_cache.h"         // For esp_cache_get_alignment
+#include "esp_heap_caps.h"     // For MALLOC_CAP_*
+#include "esp_memory_utils.h"  // For esp_ptr_dma_capable
+
+#define DMA_COPY_BACKLOG 8        // Copies that can be queued on the DMA at once
+#define DMA_COPY_MIN_ALIGNMENT 4  // Alignment of DMA copies on targets whose internal RAM is not cached
+
+static async_memcpy_handle_t s_driver = NULL;
+static size_t s_alignment = DMA_COPY_MIN_ALIGNMENT;  // The driver syncs the cache around copies, in whole lines
+
+esp_err_t dma_copy_init(void) {
+  if (s_driver) {
+    return ESP_OK;
+  }
+
+  size_t alignment = 0;
+  if (esp_cache_get_alignment(MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL, &alignment) == ESP_OK && alignment > s_alignment) {
+    s_alignment = alignment;
+  }
+  async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+  config.backlog = DMA_COPY_BACKLOG;
+  return esp_async_memcpy_install(&config, &s_driver);
+}
+
+// Completion interrupt of a copy: wakes the task waiting in dma_copy()
+static HOT_PATH_ATTR bool dma_copy_isr(async_memcpy_handle_t driver, async_memcpy_event_t *event, void *args) {
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR((SemaphoreHandle_t)args, &woken);
+  return woken == pdTRUE;
+}
+
+// Whether n bytes are worth and allowed to be copied by the DMA
+static HOT_PATH_ATTR bool dma_copy_eligible(void *dst, const void *src, size_t n) {
+  return s_driver && n >= CONFIG_VBAN_DMA_COPY_THRESHOLD && (((uintptr_t)dst | (uintptr_t)src | n) & (s_alignment - 1)) == 0 &&
+         esp_ptr_dma_capable(dst) && esp_ptr_dma_capable(src);
+}
+
+HOT_PATH_ATTR void dma_copy(void *dst, const void *src, size_t n) {
+  uint8_t *d = (uint8_t *)dst;
+  const uint8_t *s = (const uint8_t *)src;
+  size_t head = (s_alignment - ((uintptr_t)d & (s_alignment - 1))) & (s_alignment - 1);
+  // Both buffers must share their offset within a cache line for the middle to be aligned on both sides, and the
+  // caller must be able to block on the completion (not an interrupt or a critical section)
+  if (n < head + CONFIG_VBAN_DMA_COPY_THRESHOLD || (((uintptr_t)d ^ (uintptr_t)s) & (s_alignment - 1)) != 0 || xPortInIsrContext() ||
+      !xPortCanYield()) {
+    memcpy(dst, src, n);
+    return;
+  }
+  size_t middle = (n - head) & ~(s_alignment - 1);
+
+  // The semaphore lives on the stack: concurrent callers each wait for their own copy, and nothing is allocated
+  StaticSemaphore_t done_storage;
+  SemaphoreHandle_t done = xSemaphoreCreateBinaryStatic(&done_storage);
+  if (!dma_copy_eligible(d + head, s + head, middle) ||
+      esp_async_memcpy(s_driver, d + head, (void *)(s + head), middle, dma_copy_isr, done) != ESP_OK) {
+    vSemaphoreDelete(done);
+    memcpy(dst, src, n);  // CPU fallback (also when the DMA queue is full)
+    return;
+  }
+  memcpy(d, s, head);
+  memcpy(d + head + middle, s + head + middle, n - head - middle);
+  xSemaphoreTake(done, portMAX_DELAY);
+  vSemaphoreDelete(done);
+}
+
+#else  // CONFIG_VBAN_DMA_COPY
+
+esp_err_t dma_copy_init(void) { return ESP_OK; }
+
+HOT_PATH_ATTR void dma_copy(void *dst, const void *src, size_t n) { memcpy(dst, src, n); }
+
+#endif  // CONFIG_VBAN_DMA_COPY
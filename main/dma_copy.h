@@ -0,0 +1,48 @@
+#ifndef DMA_COPY_H_
+#define DMA_COPY_H_
+
+#include <stddef.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Synchronous copy offload to the async memcpy DMA (enabled with CONFIG_VBAN_DMA_COPY)
+ *
+ * Copies of at least CONFIG_VBAN_DMA_COPY_THRESHOLD bytes between DMA-capable buffers are handed to
+ * esp_async_memcpy, and the copying task sleeps until the DMA is done: the copy does not overlap the caller's own
+ * work, but the CPU is free for other tasks meanwhile. A caller must therefore not hold a lock that other tasks wait
+ * on. The DMA only takes whole cache lines; everything else (small, unaligned or non-DMA-capable copies, or no
+ * driver) is copied with memcpy. Without CONFIG_VBAN_DMA_COPY every copy is a memcpy.
+ */
+
+/**
+ * @brief Install the async memcpy driver
+ * Call at setup time: the driver allocates. Repeated calls return ESP_OK. Copies fall back to the CPU until
+ * the driver is installed, and for good if installing fails.
+ *
+ * @return
+ * - ESP_OK: Success (also when the offload is disabled)
+ * - Others: The driver could not be installed
+ */
+esp_err_t dma_copy_init(void);
+
+/**
+ * @brief Copy like memcpy, blocking the calling task while the DMA runs
+ * The DMA takes the cache-line aligned middle of the copy while the CPU copies the unaligned ends. Not for
+ * use from interrupts or critical sections (such calls copy with the CPU).
+ *
+ * @param dst Destination buffer
+ * @param src Source buffer
+ * @param n Number of bytes
+ */
+void dma_copy(void *dst, const void *src, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DMA_COPY_H_
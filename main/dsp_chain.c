@@ -0,0 +1,131 @@
+#include "dsp_chain.h"
+
+#include <string.h>  // For memset
+
+#include "esp_cpu.h"  // For esp_cpu_get_cycle_count
+#include "esp_heap_caps.h"
+#include "hot_path.h"
+#include "pcm_convert.h"
+
+esp_err_t dsp_chain_init(dsp_chain_t *chain, size_t num_channels, size_t block_frames, vban_arena_handle_t arena) {
+  if (!chain || num_channels == 0 || block_frames == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(chain, 0, sizeof(*chain));
+  // Aligned so that pcm_convert() takes its aligned kernels out of the block
+  const size_t samples = block_frames * num_channels;
+  if (arena) {
+    chain->block = (float *)vban_arena_alloc(arena, samples * sizeof(float), PCM_CONVERT_ALIGNMENT);
+  } else {
+    chain->block = (float *)heap_caps_aligned_calloc(PCM_CONVERT_ALIGNMENT, samples, sizeof(float), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  }
+  if (!chain->block) {
+    return ESP_ERR_NO_MEM;
+  }
+  chain->arena = arena;
+  chain->num_channels = num_channels;
+  chain->block_frames = block_frames;
+  return ESP_OK;
+}
+
+void dsp_chain_deinit(dsp_chain_t *chain) {
+  if (!chain) {
+    return;
+  }
+
+  if (!chain->arena) {
+    heap_caps_free(chain->block);
+  }
+  memset(chain, 0, sizeof(*chain));
+}
+
+esp_err_t dsp_chain_add_stage(dsp_chain_t *chain, const dsp_stage_t *stage) {
+  if (!chain || !stage || !stage->process) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (chain->num_stages >= DSP_CHAIN_MAX_STAGES) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  chain->stages[chain->num_stages] = *stage;
+  dsp_stage_stats_t *stats = &chain->stats[chain->num_stages];
+  memset(stats, 0, sizeof(*stats));
+  stats->name = stage->name;
+  stats->latency_frames = stage->latency_frames;
+  chain->latency_frames += stage->latency_frames;
+  chain->num_stages++;
+  return ESP_OK;
+}
+
+static HOT_PATH_ATTR void dsp_chain_gain_process(void *ctx, float *block, size_t frames, size_t num_channels) {
+  dsp_chain_gain_t *gain = (dsp_chain_gain_t *)ctx;
+  level_meter_acc_t levels = {0};
+  pcm_gain_float(block, frames * num_channels, gain->gain, &levels);
+  level_meter_add(&gain->meter, &levels);
+}
+
+esp_err_t dsp_chain_add_gain(dsp_chain_t *chain, dsp_chain_gain_t *gain) {
+  if (!gain) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const dsp_stage_t stage = {.name = "gain", .process = dsp_chain_gain_process, .ctx = gain, .latency_frames = 0};
+  return dsp_chain_add_stage(chain, &stage);
+}
+
+static HOT_PATH_ATTR void dsp_chain_eq_process(void *ctx, float *block, size_t frames, size_t num_channels) {
+  (void)num_channels;  // Fixed by biquad_eq_init()
+  biquad_eq_process((biquad_eq_t *)ctx, block, frames);
+}
+
+esp_err_t dsp_chain_add_eq(dsp_chain_t *chain, biquad_eq_t *eq) {
+  if (!chain || !eq || eq->num_channels != chain->num_channels) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  // IIR sections delay no frames (their phase shift is part of the response)
+  const dsp_stage_t stage = {.name = "eq", .process = dsp_chain_eq_process, .ctx = eq, .latency_frames = 0};
+  return dsp_chain_add_stage(chain, &stage);
+}
+
+HOT_PATH_ATTR esp_err_t dsp_chain_process(dsp_chain_t *chain, void *dst, vban_data_type_t dst_type, const void *src,
+                                          vban_data_type_t src_type, size_t frames) {
+  if (!chain || !chain->block || !dst || !src) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  const size_t channels = chain->num_channels;
+  const size_t src_frame_size = vban_get_data_type_size(src_type) * channels;
+  const size_t dst_frame_size = vban_get_data_type_size(dst_type) * channels;
+  for (size_t done = 0; done < frames;) {
+    const size_t n = frames - done < chain->block_frames ? frames - done : chain->block_frames;
+    esp_err_t ret = pcm_convert(chain->block, VBAN_DATATYPE_FLOAT32, (const uint8_t *)src + done * src_frame_size, src_type, n * channels);
+    if (ret != ESP_OK) {
+      return ret;
+    }
+    for (size_t i = 0; i < chain->num_stages; i++) {
+      const dsp_stage_t *stage = &chain->stages[i];
+      dsp_stage_stats_t *stats = &chain->stats[i];
+      const esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+      stage->process(stage->ctx, chain->block, n, channels);
+      const uint32_t cycles = (uint32_t)(esp_cpu_get_cycle_count() - start);  // Wraps safely (blocks are far shorter)
+      stats->cycles += cycles;
+      stats->cycles_max = cycles > stats->cycles_max ? cycles : stats->cycles_max;
+      stats->frames += n;
+    }
+    ret = pcm_convert((uint8_t *)dst + done * dst_frame_size, dst_type, chain->block, VBAN_DATATYPE_FLOAT32, n * channels);
+    if (ret != ESP_OK) {
+      return ret;
+    }
+    done += n;
+  }
+  return ESP_OK;
+}
+
+esp_err_t dsp_chain_get_stats(const dsp_chain_t *chain, size_t index, dsp_stage_stats_t *stats) {
+  if (!chain || !stats || index >= chain->num_stages) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  *stats = chain->stats[index];
+  return ESP_OK;
+}
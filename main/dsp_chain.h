@@ -0,0 +1,172 @@
+#ifndef DSP_CHAIN_H_
+#define DSP_CHAIN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "biquad_eq.h"
+#include "esp_err.h"
+#include "level_meter.h"
+#include "vban.h"  // For vban_data_type_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSP_CHAIN_MAX_STAGES 8  // Max stages of one chain
+
+/**
+ * @brief Processing function of a stage
+ * Processes frames interleaved float frames (full scale 1.0) in place. frames is at most the block size of the
+ * chain, so a stage can size its state for one block at setup time. Must not block or allocate.
+ *
+ * @param ctx Context of the stage
+ * @param block Frames to process in place
+ * @param frames Number of frames (1 to the chain's block_frames)
+ * @param num_channels Interleaved channels per frame
+ */
+typedef void (*dsp_stage_process_fn_t)(void *ctx, float *block, size_t frames, size_t num_channels);
+
+/**
+ * @brief Stage of a chain, as added by dsp_chain_add_stage()
+ */
+typedef struct {
+  const char *name;                /**< Name shown in reports */
+  dsp_stage_process_fn_t process;  /**< Processing function */
+  void *ctx;                       /**< Context passed to process (owned by the caller) */
+  uint32_t latency_frames;         /**< Delay the stage adds to the signal, in frames */
+} dsp_stage_t;
+
+/**
+ * @brief Cost of a stage, measured around each call of its processing function
+ */
+typedef struct {
+  const char *name;         /**< Name of the stage */
+  uint32_t latency_frames;  /**< Declared latency of the stage */
+  uint64_t cycles;          /**< CPU cycles spent in the stage */
+  uint32_t cycles_max;      /**< Most CPU cycles spent on one block */
+  uint64_t frames;          /**< Frames processed by the stage */
+} dsp_stage_stats_t;
+
+/**
+ * @brief Gain stage context: scales the block and meters the result in the same loop
+ */
+typedef struct {
+  volatile float gain;  /**< Linear gain, may be changed while processing */
+  level_meter_t meter;  /**< Levels after the gain (see level_meter_read()) */
+} dsp_chain_gain_t;
+
+/**
+ * @brief Chain of in-place processing stages run block by block
+ *
+ * The block size and channel count are fixed by dsp_chain_init(), which also allocates the float block the
+ * stages run on (from the pipeline's arena or the heap); stages are added at setup time. Processing then touches
+ * no heap: frames are converted into the block, each stage runs in order on it, and the result is converted to the
+ * output type. Format conversion and channel routing change the size or layout of the samples, so they are not
+ * stages: the chain converts at its edges and routing follows it. The cycles of every stage are counted, and the
+ * chain's latency is the sum of the declared latencies of its stages. Stages run on the calling task in a fixed
+ * order, so the output depends only on the input and the stages' state.
+ */
+typedef struct {
+  size_t num_channels;                            /**< Interleaved channels per frame */
+  size_t block_frames;                            /**< Frames per block */
+  float *block;                                   /**< Block the stages process (block_frames * num_channels samples) */
+  vban_arena_handle_t arena;                      /**< Arena block was carved from (NULL for the heap) */
+  dsp_stage_t stages[DSP_CHAIN_MAX_STAGES];       /**< Stages, in processing order */
+  dsp_stage_stats_t stats[DSP_CHAIN_MAX_STAGES];  /**< Cost of each stage */
+  size_t num_stages;                              /**< Number of stages */
+  uint32_t latency_frames;                        /**< Sum of the latencies of the stages */
+} dsp_chain_t;
+
+/**
+ * @brief Initialize an empty chain and allocate its block
+ *
+ * @param chain Pointer to the chain structure
+ * @param num_channels Interleaved channels per frame
+ * @param block_frames Frames per block
+ * @param arena Arena to carve the block from (see vban_arena_alloc()), or NULL for the heap
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL chain, zero channels or zero block size
+ * - ESP_ERR_NO_MEM: Out of memory
+ */
+esp_err_t dsp_chain_init(dsp_chain_t *chain, size_t num_channels, size_t block_frames, vban_arena_handle_t arena);
+
+/**
+ * @brief Release the block of the chain (the stages' contexts belong to the caller)
+ * A block carved from an arena is released with the arena.
+ *
+ * @param chain Pointer to the chain structure
+ */
+void dsp_chain_deinit(dsp_chain_t *chain);
+
+/**
+ * @brief Append a stage (at setup time, not while processing)
+ *
+ * @param chain Pointer to the chain structure
+ * @param stage Stage to append (copied)
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer or processing function
+ * - ESP_ERR_NO_MEM: The chain already has DSP_CHAIN_MAX_STAGES stages
+ */
+esp_err_t dsp_chain_add_stage(dsp_chain_t *chain, const dsp_stage_t *stage);
+
+/**
+ * @brief Append a gain stage
+ *
+ * @param chain Pointer to the chain structure
+ * @param gain Gain context, initialized with gain and a meter (see level_meter_init())
+ * @return Same as dsp_chain_add_stage()
+ */
+esp_err_t dsp_chain_add_gain(dsp_chain_t *chain, dsp_chain_gain_t *gain);
+
+/**
+ * @brief Append an equalizer stage (the coefficients can still be changed with biquad_eq_set_sections())
+ *
+ * @param chain Pointer to the chain structure
+ * @param eq Equalizer with the chain's channel count
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer or channel count mismatch
+ * - ESP_ERR_NO_MEM: The chain already has DSP_CHAIN_MAX_STAGES stages
+ */
+esp_err_t dsp_chain_add_eq(dsp_chain_t *chain, biquad_eq_t *eq);
+
+/**
+ * @brief Run the stages on interleaved PCM, block by block
+ * Blocks of block_frames frames are converted to float, processed by every stage and converted to dst_type
+ * (clamped to full scale); the last block may be shorter. dst may be src when both have the same type.
+ *
+ * @param chain Pointer to the chain structure
+ * @param dst Destination buffer (frames * num_channels samples of dst_type)
+ * @param dst_type Destination data type (see pcm_convert_is_output_supported())
+ * @param src Source buffer
+ * @param src_type Source data type
+ * @param frames Number of frames
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer
+ * - ESP_ERR_NOT_SUPPORTED: Unsupported source or destination type
+ */
+esp_err_t dsp_chain_process(dsp_chain_t *chain, void *dst, vban_data_type_t dst_type, const void *src, vban_data_type_t src_type,
+                            size_t frames);
+
+/**
+ * @brief Get the cost of a stage
+ * The counters are updated by the processing task without locking, so a read while processing may mix two blocks.
+ *
+ * @param chain Pointer to the chain structure
+ * @param index Index of the stage (order of the add calls)
+ * @param[out] stats Cost of the stage
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer or unknown index
+ */
+esp_err_t dsp_chain_get_stats(const dsp_chain_t *chain, size_t index, dsp_stage_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DSP_CHAIN_H_
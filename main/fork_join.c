@@ -0,0 +1,95 @@
+#include "fork_join.h"
+
+#include <string.h>  // For memset
+
+#include "alloc_guard.h"
+#include "esp_heap_caps.h"
+#include "hot_path.h"
+
+#define FORK_JOIN_PARK_POLL_MS 10  // Poll interval while waiting for the exiting worker to park
+
+// Claim and run jobs until none is left
+static HOT_PATH_ATTR void fork_join_work(fork_join_t *fj) {
+  size_t index;
+  while ((index = atomic_fetch_add_explicit(&fj->next, 1, memory_order_relaxed)) < fj->num_jobs) {
+    fj->fn(fj->ctx, index);
+  }
+}
+
+static void fork_join_worker(void *arg) {
+  fork_join_t *fj = (fork_join_t *)arg;
+  alloc_guard_watch_task(NULL);
+
+  while (true) {
+    xSemaphoreTake(fj->start, portMAX_DELAY);
+    if (fj->exit) {
+      break;
+    }
+    fork_join_work(fj);
+    xSemaphoreGive(fj->done);
+  }
+
+  alloc_guard_unwatch_task(NULL);
+  xSemaphoreGive(fj->done);
+  vTaskSuspend(NULL);  // Park; deleted by fork_join_deinit() once its static memory is no longer in use
+}
+
+esp_err_t fork_join_init(fork_join_t *fj, int worker_core_id, UBaseType_t priority, size_t stack_size, StackType_t *stack) {
+  if (!fj || worker_core_id < 0 || worker_core_id >= CONFIG_FREERTOS_NUMBER_OF_CORES) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(fj, 0, sizeof(*fj));
+  fj->start = xSemaphoreCreateBinaryStatic(&fj->start_storage);
+  fj->done = xSemaphoreCreateBinaryStatic(&fj->done_storage);
+  atomic_init(&fj->next, 0);
+  fj->owns_stack = stack == NULL;
+  fj->worker_stack = stack ? stack : (StackType_t *)heap_caps_malloc(stack_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!fj->worker_stack) {
+    return ESP_ERR_NO_MEM;
+  }
+  fj->worker = xTaskCreateStaticPinnedToCore(fork_join_worker, "fork_join", stack_size, fj, priority, fj->worker_stack, &fj->worker_tcb,
+                                             worker_core_id);
+  if (!fj->worker) {
+    if (fj->owns_stack) {
+      heap_caps_free(fj->worker_stack);
+    }
+    fj->worker_stack = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+void fork_join_deinit(fork_join_t *fj) {
+  if (!fj || !fj->worker) {
+    return;
+  }
+
+  fj->exit = true;
+  xSemaphoreGive(fj->start);
+  xSemaphoreTake(fj->done, portMAX_DELAY);
+  while (eTaskGetState(fj->worker) != eSuspended) {
+    vTaskDelay(pdMS_TO_TICKS(FORK_JOIN_PARK_POLL_MS));
+  }
+  vTaskDelete(fj->worker);
+  fj->worker = NULL;
+  if (fj->owns_stack) {
+    heap_caps_free(fj->worker_stack);
+  }
+  fj->worker_stack = NULL;
+}
+
+HOT_PATH_ATTR void fork_join_run(fork_join_t *fj, fork_join_fn_t fn, void *ctx, size_t num_jobs) {
+  fj->fn = fn;
+  fj->ctx = ctx;
+  fj->num_jobs = num_jobs;
+  atomic_store_explicit(&fj->next, 0, memory_order_relaxed);  // Published to the worker by the semaphore
+
+  if (num_jobs <= 1 || !fj->worker) {
+    fork_join_work(fj);
+    return;
+  }
+  xSemaphoreGive(fj->start);
+  fork_join_work(fj);
+  xSemaphoreTake(fj->done, portMAX_DELAY);  // The worker only gives it once it stopped touching the jobs
+}
@@ -0,0 +1,83 @@
+#ifndef FORK_JOIN_H_
+#define FORK_JOIN_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*fork_join_fn_t)(void *ctx, size_t index);  // Runs job index; jobs of one run may run in parallel
+
+/**
+ * @brief Fork-join scheduler over two cores
+ *
+ * fork_join_run() shares a set of independent jobs between the calling task and a worker task pinned to another
+ * core: both claim job indices from a shared counter until none is left, and the call returns once every job
+ * has finished. Which core runs which job changes from run to run, so a job must only write its own outputs;
+ * combining the outputs afterwards in index order keeps the results deterministic. Runs neither allocate nor
+ * create tasks.
+ */
+typedef struct {
+  TaskHandle_t worker;              /**< Worker task (NULL until initialized) */
+  StaticTask_t worker_tcb;          /**< Control block of the worker */
+  StackType_t *worker_stack;        /**< Stack of the worker */
+  bool owns_stack;                  /**< worker_stack was allocated by fork_join_init() */
+  SemaphoreHandle_t start;          /**< Given by fork_join_run() to start the worker */
+  SemaphoreHandle_t done;           /**< Given by the worker when it found no job left */
+  StaticSemaphore_t start_storage;  /**< Memory of start */
+  StaticSemaphore_t done_storage;   /**< Memory of done */
+  fork_join_fn_t fn;                /**< Job function of the current run */
+  void *ctx;                        /**< Context of the current run */
+  size_t num_jobs;                  /**< Number of jobs of the current run */
+  atomic_size_t next;               /**< Next job index to claim */
+  volatile bool exit;               /**< Set by fork_join_deinit() to end the worker */
+} fork_join_t;
+
+/**
+ * @brief Initialize a scheduler and start its worker
+ *
+ * @param fj Pointer to the scheduler structure
+ * @param worker_core_id Core of the worker (0 or 1); run fork_join_run() from a task on the other core
+ * @param priority Priority of the worker (usually that of the calling task)
+ * @param stack_size Stack of the worker in bytes (must fit the deepest job)
+ * @param stack Memory of the stack (stack_size bytes, e.g. from vban_arena_alloc()), or NULL to allocate it from
+ *              the heap; must outlive the scheduler
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL scheduler or invalid core
+ * - ESP_ERR_NO_MEM: The worker could not be created
+ */
+esp_err_t fork_join_init(fork_join_t *fj, int worker_core_id, UBaseType_t priority, size_t stack_size, StackType_t *stack);
+
+/**
+ * @brief Stop the worker and release the scheduler
+ * Must not be called while a run is in progress.
+ *
+ * @param fj Pointer to the scheduler structure
+ */
+void fork_join_deinit(fork_join_t *fj);
+
+/**
+ * @brief Run jobs 0 to num_jobs - 1 on both cores and wait for all of them
+ * A single job runs on the calling task without waking the worker. Only one task may run at a time.
+ *
+ * @param fj Pointer to the scheduler structure
+ * @param fn Job function
+ * @param ctx Context passed to fn
+ * @param num_jobs Number of jobs
+ */
+void fork_join_run(fork_join_t *fj, fork_join_fn_t fn, void *ctx, size_t num_jobs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // FORK_JOIN_H_
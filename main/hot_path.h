@@ -0,0 +1,16 @@
+#ifndef HOT_PATH_H_
+#define HOT_PATH_H_
+
+#include "esp_attr.h"  // For IRAM_ATTR
+#include "sdkconfig.h"
+
+// Marks functions that run per packet or per I2S write (receive loop, ring operations, sample format kernels,
+// pull API). With CONFIG_VBAN_HOT_PATH_IRAM they are placed in internal RAM and run without flash cache misses;
+// otherwise they stay in flash like the rest of the code. Functions they call keep their own placement.
+#if CONFIG_VBAN_HOT_PATH_IRAM
+#define HOT_PATH_ATTR IRAM_ATTR
+#else
+#define HOT_PATH_ATTR
+#endif
+
+#endif  // HOT_PATH_H_
@@ -0,0 +1,51 @@
+#include "level_meter.h"
+
+#include <math.h>    // For sqrtf
+#include <string.h>  // For memset
+
+#include "hot_path.h"
+
+esp_err_t level_meter_init(level_meter_t *meter, uint32_t window_samples) {
+  if (!meter || window_samples == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(&meter->acc, 0, sizeof(meter->acc));
+  memset(&meter->levels, 0, sizeof(meter->levels));
+  meter->window_samples = window_samples;
+  meter->clips = 0;
+  atomic_init(&meter->seq, 0);
+  return ESP_OK;
+}
+
+HOT_PATH_ATTR void level_meter_add(level_meter_t *meter, const level_meter_acc_t *block) {
+  level_meter_acc_merge(&meter->acc, block, block->samples);
+  if (meter->acc.samples < meter->window_samples) {
+    return;
+  }
+
+  // One square root per window; everything per sample was done by the kernels
+  meter->clips += meter->acc.clips;
+  level_meter_levels_t levels = {
+      .peak = (uint16_t)meter->acc.peak,
+      .rms = (uint16_t)sqrtf((float)meter->acc.sum_squares / (float)meter->acc.samples),
+      .clips = meter->clips,
+  };
+  memset(&meter->acc, 0, sizeof(meter->acc));
+
+  const unsigned seq = atomic_load_explicit(&meter->seq, memory_order_relaxed);  // Only this task writes seq
+  atomic_store_explicit(&meter->seq, seq + 1, memory_order_relaxed);             // Odd: readers retry
+  atomic_thread_fence(memory_order_release);                                     // The odd count is visible before the levels
+  meter->levels = levels;
+  atomic_store_explicit(&meter->seq, seq + 2, memory_order_release);  // Publishes the levels
+}
+
+void level_meter_read(level_meter_t *meter, level_meter_levels_t *levels) {
+  unsigned begin, end;
+  do {
+    begin = atomic_load_explicit(&meter->seq, memory_order_acquire);
+    *levels = meter->levels;
+    atomic_thread_fence(memory_order_acquire);  // The copy is complete before seq is checked again
+    end = atomic_load_explicit(&meter->seq, memory_order_relaxed);
+  } while ((begin & 1) != 0 || begin != end);
+}
@@ -0,0 +1,111 @@
+#ifndef LEVEL_METER_H_
+#define LEVEL_METER_H_
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LEVEL_METER_FULL_SCALE 32768  // Levels are magnitudes on a 16-bit scale, whatever the sample type
+#define LEVEL_METER_CLIP_LEVEL 32767  // Magnitude counted as a clip (a sample at or beyond full scale)
+
+/**
+ * @brief Levels of one block, accumulated by the kernels that touch the samples anyway
+ *
+ * Conversion and gain kernels (see pcm_convert_metered() and pcm_gain_float()) keep one of these in registers
+ * while they run and merge it once per call, so metering adds no pass over the samples and no memory traffic.
+ */
+typedef struct {
+  uint32_t peak;         /**< Largest magnitude (0 to LEVEL_METER_FULL_SCALE) */
+  uint32_t clips;        /**< Samples at LEVEL_METER_CLIP_LEVEL or above */
+  uint64_t sum_squares;  /**< Sum of the squared magnitudes */
+  uint32_t samples;      /**< Samples accumulated */
+} level_meter_acc_t;
+
+/**
+ * @brief Published levels
+ */
+typedef struct {
+  uint16_t peak;   /**< Peak magnitude of the last window (0 to LEVEL_METER_FULL_SCALE) */
+  uint16_t rms;    /**< RMS magnitude of the last window (0 to LEVEL_METER_FULL_SCALE) */
+  uint32_t clips;  /**< Clipped samples since the meter was initialized */
+} level_meter_levels_t;
+
+/**
+ * @brief Peak/RMS/clip meter with lock-free snapshot reads
+ *
+ * One task (the one running the kernels) adds block accumulators; every window_samples samples it publishes
+ * the levels of the window. Readers on any task or core copy the last published levels under a sequence
+ * counter (a seqlock): the writer never waits, and a reader retries only if it raced with a publication.
+ */
+typedef struct {
+  level_meter_acc_t acc;        /**< Accumulated since the last publication (writer only) */
+  uint32_t window_samples;      /**< Samples per published window */
+  uint32_t clips;               /**< Clipped samples so far (writer only) */
+  atomic_uint seq;              /**< Publication counter, odd while levels is being written */
+  level_meter_levels_t levels;  /**< Last published levels */
+} level_meter_t;
+
+// Accumulate one left-justified 32-bit sample (integer sources)
+static inline void level_meter_acc_q31(level_meter_acc_t *acc, int32_t v) {
+  const int32_t s = v >> 16;  // 16 bits are plenty for a meter, and the squares fit 32 bits
+  const uint32_t mag = (uint32_t)(s < 0 ? -s : s);
+  acc->peak = mag > acc->peak ? mag : acc->peak;
+  acc->clips += mag >= LEVEL_METER_CLIP_LEVEL;
+  acc->sum_squares += mag * mag;
+}
+
+// Accumulate one float sample (full scale 1.0; values beyond it count as clips)
+static inline void level_meter_acc_float(level_meter_acc_t *acc, float v) {
+  const float a = (v < 0.0f ? -v : v) * (float)LEVEL_METER_FULL_SCALE;
+  const uint32_t mag = a >= (float)LEVEL_METER_FULL_SCALE ? LEVEL_METER_FULL_SCALE : (uint32_t)a;
+  acc->peak = mag > acc->peak ? mag : acc->peak;
+  acc->clips += mag >= LEVEL_METER_CLIP_LEVEL;
+  acc->sum_squares += mag * mag;
+}
+
+// Merge the accumulator of a kernel call of num_samples samples into dst
+static inline void level_meter_acc_merge(level_meter_acc_t *dst, const level_meter_acc_t *src, size_t num_samples) {
+  dst->peak = src->peak > dst->peak ? src->peak : dst->peak;
+  dst->clips += src->clips;
+  dst->sum_squares += src->sum_squares;
+  dst->samples += num_samples;
+}
+
+/**
+ * @brief Initialize a meter with zero levels
+ *
+ * @param meter Pointer to the meter structure
+ * @param window_samples Samples per published window (e.g. 50 ms of interleaved samples)
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL meter or zero window
+ */
+esp_err_t level_meter_init(level_meter_t *meter, uint32_t window_samples);
+
+/**
+ * @brief Add the accumulator of a block and publish the window when it is complete (writer only)
+ *
+ * @param meter Pointer to the meter structure
+ * @param block Accumulator filled by the kernels
+ */
+void level_meter_add(level_meter_t *meter, const level_meter_acc_t *block);
+
+/**
+ * @brief Copy the last published levels (any task, lock-free)
+ *
+ * @param meter Pointer to the meter structure
+ * @param[out] levels Receives the levels
+ */
+void level_meter_read(level_meter_t *meter, level_meter_levels_t *levels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LEVEL_METER_H_
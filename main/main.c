@@ -1,129 +1,478 @@
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
-#include "circular_buffer.h"
+#include "alloc_guard.h"
+#include "biquad_eq.h"
+#include "dsp_chain.h"
 #include "esp_err.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
 #include "freertos/task.h"
+#include "hot_path.h"
 #include "network.h"
 #include "nvs_flash.h"
 #include "p4nano_audio.h"
+#include "pcm_convert.h"
+#include "stream_mixer.h"
 #include "vban.h"
 
 static const char* TAG = "vban_demo";
-static circular_buffer_t cb;
 
 #define VBAN_LISTEN_PORT VBAN_DEFAULT_PORT  // Or the port specified by the sender
 #define VBAN_EXPECTED_STREAM "TestStream1"  // Stream name to receive (empty string to receive any stream)
 #define SPEAKER_VOLUME 60                   // Volume level (0-100)
 #define SAMPLE_RATE 48000                   // Sample rate in Hz
-#define BIT_DEPTH 16                        // Bit depth
+#if CONFIG_VBAN_DEMO_OUTPUT_32BIT
+#define BIT_DEPTH 32                          // 32-bit slots; the ES8311 DAC resolves the top 24 bits
+#define OUTPUT_DATA_TYPE VBAN_DATATYPE_INT32  // Left-justified: 24-bit and float streams keep their resolution
+#else
+#define BIT_DEPTH 16                          // Bit depth
+#define OUTPUT_DATA_TYPE VBAN_DATATYPE_INT16  // Sample type written to I2S
+#endif
 #define CHANNEL_COUNT 1                     // Number of channels (1 for mono, 2 for stereo)
-#define AUDIO_BUFFER_SIZE 32                // Buffer size for audio data in bytes
-#define AUDIO_BUFFER_QUEUE_COUNT (VBAN_MAX_PAYLOAD_SIZE / AUDIO_BUFFER_SIZE + 2)  // Number of audio buffers in the queue
+#define AUDIO_BUFFER_SIZE 32                // Max bytes handed to the I2S driver per write
+#define AUDIO_FRAME_SIZE (CHANNEL_COUNT * BIT_DEPTH / 8)  // Bytes per frame of the pulled PCM
+#define PIPELINE_ARENA_SIZE (48 * 1024)                   // Memory of a receive pipeline (see the usage logged at startup)
+#define WRITER_STACK_SIZE 3072                            // Stack of the I2S writer task in bytes
+#define TDM_SLOTS CONFIG_VBAN_DEMO_TDM_SLOTS              // TDM slots per frame (0 for standard I2S to the codec)
+#define NUM_ZONES CONFIG_VBAN_DEMO_ZONES                  // Output zones, each playing its own stream on its own I2S peripheral
+#define SILENCE_GATE_MS CONFIG_VBAN_DEMO_SILENCE_GATE_MS  // Silence before a zone idles and mutes its amplifier (0 to disable)
+#define SILENCE_THRESHOLD 0                               // Peak on the 16-bit meter scale counted as silence (0: digital silence)
+#define IDLE_POLL_MS 50                                   // Writer wakeup period while no frames arrive, to check for idling
+#ifdef CONFIG_VBAN_DEMO_MIX_STREAMS
+#define MIX_STREAMS CONFIG_VBAN_DEMO_MIX_STREAMS  // Streams mixed into zone 0 (1: the zone plays its stream unmixed)
+#else
+#define MIX_STREAMS 1
+#endif
+#define MIX_BLOCK_FRAMES 128          // Frames per mixed block, written to I2S in AUDIO_BUFFER_SIZE pieces
+#define MIX_WORKER_STACK_SIZE 3072    // Stack of the mixer's fork-join worker in bytes
 
+#if TDM_SLOTS > 0
+#define TDM_FRAME_SIZE (TDM_SLOTS * BIT_DEPTH / 8)
+#endif
+#define DSP_BLOCK_FRAMES (AUDIO_BUFFER_SIZE / AUDIO_FRAME_SIZE)  // Block size of the output processing chain (one write)
+#if CONFIG_VBAN_DEMO_EQ
+// Example room-correction curve, applied to every zone (replace with a measured curve)
 typedef struct {
-  uint8_t* buffer;
-  size_t size;
-} audio_buffer_t;
+  biquad_type_t type;
+  float freq, q, gain_db;
+} eq_band_t;
 
-static QueueHandle_t audio_queue;
+static const eq_band_t s_eq_bands[] = {
+    {BIQUAD_LOW_SHELF, 100.0f, 0.707f, 3.0f},     // Lift the bass of small speakers
+    {BIQUAD_PEAKING, 250.0f, 1.4f, -4.0f},        // Tame a room mode
+    {BIQUAD_HIGH_SHELF, 8000.0f, 0.707f, -2.0f},  // Soften the treble
+};
+#define EQ_SECTIONS (sizeof(s_eq_bands) / sizeof(s_eq_bands[0]))
+#endif
 
-static void vban_receive_callback(const vban_header_t* header, const uint8_t* audio_data, size_t audio_data_len, const char* sender_ip,
-                                  uint16_t sender_port, void* user_context) {
-  uint32_t actual_sr = vban_get_sr_from_index((vban_sample_rate_index_t)(header->sr_subprotocol & VBAN_SR_INDEX_MASK));
-  uint8_t num_channels = header->channels_m1 + 1;
-  vban_data_type_t data_type = (vban_data_type_t)(header->format_codec & VBAN_DATATYPE_MASK);
+// Zone 0 plays on the onboard codec; further zones drive external DACs or amplifiers on their own I2S peripheral and
+// pins (MCLK is not routed: use DACs that derive their clock from BCLK, or adjust the pins to your wiring). Each zone
+// receives its own stream on its own port. Its output side (receiver stage 2 and I2S writer) runs on output_core and
+// its network side on the other core, alternating between zones so that both cores carry output work.
+typedef struct {
+  const char* stream_name;
+  uint16_t port;
+  int i2s_num;
+  gpio_num_t bclk, ws, dout;  // Unused by zone 0 (board pins of the codec)
+  int output_core;
+} zone_config_t;
 
-  // Check if the received audio data matches the expected format
-  if (actual_sr != SAMPLE_RATE) {
-    ESP_LOGV(TAG, "Received sample rate %d does not match expected %d", (int)actual_sr, SAMPLE_RATE);
-    return;
-  }
-  if (num_channels != CHANNEL_COUNT) {
-    ESP_LOGV(TAG, "Received channel count %d does not match expected %d", (int)num_channels, CHANNEL_COUNT);
-    return;
+static const zone_config_t s_zone_configs[] = {
+    {VBAN_EXPECTED_STREAM, VBAN_LISTEN_PORT, CONFIG_BSP_I2S_NUM, GPIO_NUM_NC, GPIO_NUM_NC, GPIO_NUM_NC, 1},
+    {"TestStream2", VBAN_LISTEN_PORT + 1, 1, GPIO_NUM_20, GPIO_NUM_21, GPIO_NUM_22, 0},
+    {"TestStream3", VBAN_LISTEN_PORT + 2, 2, GPIO_NUM_23, GPIO_NUM_32, GPIO_NUM_33, 1},
+};
+_Static_assert(NUM_ZONES <= sizeof(s_zone_configs) / sizeof(s_zone_configs[0]), "Not enough zone configurations");
+_Static_assert(MIX_STREAMS <= sizeof(s_zone_configs) / sizeof(s_zone_configs[0]), "Not enough stream configurations to mix");
+
+// Runtime state of a zone. The writer task is created on static memory, like the receiver's task (whose stack comes
+// from the zone's arena)
+typedef struct {
+  const zone_config_t* config;
+  vban_arena_handle_t arena;
+  vban_handle_t receiver;
+#if MIX_STREAMS > 1
+  // Mixing: receiver plays the first stream of the mix, mix_inputs the others (see s_zone_configs)
+  vban_handle_t mix_inputs[MIX_STREAMS - 1];
+  stream_mixer_t mixer;
+  uint8_t mix_block[MIX_BLOCK_FRAMES * AUDIO_FRAME_SIZE] __attribute__((aligned(4)));
+#endif
+  bsp_audio_output_handle_t output;  // Output created for the zone (NULL on zone 0, which plays on the codec's output)
+  i2s_chan_handle_t tx_handle;
+  TaskHandle_t writer_task;
+  StaticTask_t writer_tcb;
+  StackType_t writer_stack[WRITER_STACK_SIZE];
+  volatile uint32_t writer_frames;  // Frames handed to the I2S driver, to relate the writer's CPU time to audio time
+  bool has_amp;                     // The zone plays on the onboard codec and its power amplifier
+  bool amp_on;                      // State of the power amplifier (has_amp only)
+  // Output processing: the stages of the chain run on a float copy of the frames, converted back into dsp_out
+  dsp_chain_t dsp_chain;
+  uint8_t dsp_out[AUDIO_BUFFER_SIZE] __attribute__((aligned(4)));
+#if CONFIG_VBAN_DEMO_EQ
+  biquad_eq_t eq;
+#endif
+#if TDM_SLOTS > 0
+  // TDM output: every slot plays one channel of the stream (channel s % CHANNEL_COUNT in slot s), interleaved
+  // straight into this block of TDM frames
+  uint8_t tdm_block[AUDIO_BUFFER_SIZE / AUDIO_FRAME_SIZE * TDM_FRAME_SIZE] __attribute__((aligned(4)));
+#endif
+} zone_t;
+
+static zone_t s_zones[NUM_ZONES];
+#if TDM_SLOTS > 0
+static int8_t s_tdm_map[TDM_SLOTS];
+#endif
+
+// Write frames to the zone's output through its processing chain and TDM routing. Fails without writing if processing
+// fails, so the caller drops the frames rather than play them unprocessed.
+static HOT_PATH_ATTR esp_err_t zone_write(zone_t* zone, const void* data, size_t size) {
+  const void* out = data;
+  size_t out_size = size;
+  if (zone->dsp_chain.num_stages > 0) {
+    // The ring holds the I2S format, so without stages the path stays zero-copy
+    esp_err_t dsp_ret =
+        dsp_chain_process(&zone->dsp_chain, zone->dsp_out, OUTPUT_DATA_TYPE, data, OUTPUT_DATA_TYPE, size / AUDIO_FRAME_SIZE);
+    if (dsp_ret != ESP_OK) {
+      ESP_LOGE(TAG, "[writer] Output processing failed: %s", esp_err_to_name(dsp_ret));
+      return dsp_ret;
+    }
+    out = zone->dsp_out;
   }
-  if (data_type != VBAN_DATATYPE_INT16) {
-    ESP_LOGV(TAG, "Received data type %d does not match expected %d", data_type, VBAN_DATATYPE_INT16);
-    return;
+#if TDM_SLOTS > 0
+  esp_err_t route_ret = pcm_route(zone->tdm_block, TDM_SLOTS, out, CHANNEL_COUNT, s_tdm_map, OUTPUT_DATA_TYPE, size / AUDIO_FRAME_SIZE);
+  if (route_ret != ESP_OK) {
+    ESP_LOGE(TAG, "[writer] TDM routing failed: %s", esp_err_to_name(route_ret));
+    return route_ret;
   }
+  out = zone->tdm_block;
+  out_size = size / AUDIO_FRAME_SIZE * TDM_FRAME_SIZE;
+#endif
 
-  // Copy audio data to buffer
-  int ret = circular_buffer_write(&cb, audio_data, audio_data_len);
-  if (ret != CB_SUCCESS) {
-    ESP_LOGE(TAG, "Failed to write to circular buffer: %d", ret);
-    return;
+  size_t bytes_written = 0;
+  esp_err_t ret = i2s_channel_write(zone->tx_handle, out, out_size, &bytes_written, portMAX_DELAY);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "[writer] i2s write failed");
+    abort();
+  }
+  if (bytes_written != out_size) {
+    ESP_LOGW(TAG, "[writer] %d bytes should be written but only %d bytes are written", out_size, bytes_written);
   }
+  zone->writer_frames += size / AUDIO_FRAME_SIZE;
+  return ESP_OK;
+}
+
+static HOT_PATH_ATTR void i2s_writer(void* args) {
+  zone_t* zone = (zone_t*)args;
+  vban_handle_t receiver_handle = zone->receiver;
+  const uint32_t peek_timeout_ms = SILENCE_GATE_MS > 0 ? IDLE_POLL_MS : VBAN_WAIT_FOREVER;
+  alloc_guard_watch_task(NULL);
 
-  // Send audio data to I2S writer task if the buffer has enough data
-  while (circular_buffer_get_count(&cb) >= AUDIO_BUFFER_SIZE) {
-    size_t readable_bytes = 0;
-    void* readable_region = circular_buffer_get_readable_region(&cb, &readable_bytes);
-    if (readable_region == NULL) {
-      ESP_LOGE(TAG, "Failed to get readable region from circular buffer");
-      return;
+  while (1) {
+    // Write straight from the receiver's ring (zero-copy peek/release)
+    const void* data = NULL;
+    size_t frames = 0;
+    if (vban_receiver_peek(receiver_handle, &data, &frames, peek_timeout_ms) != ESP_OK) {
+      // The ring ran dry: if the receiver's silence gate is idle, the ramp down has been played and the amplifier
+      // can be muted (the I2S DMA keeps sending zeros)
+      bool idle = false;
+      if (zone->amp_on && vban_receiver_get_idle(receiver_handle, &idle) == ESP_OK && idle) {
+        bsp_audio_power_amp_enable(false);
+        zone->amp_on = false;
+        ESP_LOGI(TAG, "[writer] Silence: power amplifier off");
+      }
+      continue;
     }
-    if (readable_bytes < AUDIO_BUFFER_SIZE) {
-      // Should not happen, but just in case
-      ESP_LOGE(TAG, "Not enough readable bytes in circular buffer: %zu", readable_bytes);
-      return;
+    if (zone->has_amp && !zone->amp_on) {
+      // Before the first frames of the packet that re-opened the gate, so the onset is played
+      bsp_audio_power_amp_enable(true);
+      zone->amp_on = true;
+      ESP_LOGI(TAG, "[writer] Signal: power amplifier on");
     }
-    audio_buffer_t audio_buf;
-    audio_buf.buffer = (uint8_t*)readable_region;
-    audio_buf.size = AUDIO_BUFFER_SIZE;
-    // Send audio buffer to I2S writer task
-    if (xQueueSend(audio_queue, &audio_buf, portMAX_DELAY) != pdPASS) {
-      ESP_LOGE(TAG, "Failed to send audio buffer to queue");
-      return;
+    size_t size = frames * AUDIO_FRAME_SIZE;
+    if (size > AUDIO_BUFFER_SIZE) {
+      size = AUDIO_BUFFER_SIZE - AUDIO_BUFFER_SIZE % AUDIO_FRAME_SIZE;
     }
-    // Consume the data from the circular buffer
-    ret = circular_buffer_consume(&cb, AUDIO_BUFFER_SIZE);
-    if (ret != CB_SUCCESS) {
-      ESP_LOGE(TAG, "Failed to consume data from circular buffer: %d", ret);
-      return;
+    zone_write(zone, data, size);  // On error the frames are dropped
+    vban_receiver_release(receiver_handle, size / AUDIO_FRAME_SIZE);
+  }
+}
+
+#if MIX_STREAMS > 1
+// Writer of a mixing zone: the mixer pads late inputs with silence instead of waiting, so the I2S writes pace the
+// loop. The amplifier stays on.
+static HOT_PATH_ATTR void i2s_mix_writer(void* args) {
+  zone_t* zone = (zone_t*)args;
+  const size_t chunk = AUDIO_BUFFER_SIZE - AUDIO_BUFFER_SIZE % AUDIO_FRAME_SIZE;
+  alloc_guard_watch_task(NULL);
+
+  while (1) {
+    stream_mixer_mix(&zone->mixer, zone->mix_block);
+    for (size_t offset = 0; offset < sizeof(zone->mix_block); offset += chunk) {
+      const size_t size = sizeof(zone->mix_block) - offset < chunk ? sizeof(zone->mix_block) - offset : chunk;
+      zone_write(zone, zone->mix_block + offset, size);  // On error the frames are dropped
     }
   }
 }
+#endif
 
-static void i2s_writer(void* args) {
-  audio_buffer_t audio_buf;
-  i2s_chan_handle_t tx_handle = NULL;
-  bsp_audio_get_i2s_handle(&tx_handle, NULL);
-  if (!tx_handle) {
-    ESP_LOGE(TAG, "[writer] Failed to get I2S handle");
-    abort();
+// Create the I2S output of a zone other than zone 0, on the zone's peripheral and pins
+static esp_err_t zone_output_create(zone_t* zone) {
+  const zone_config_t* config = zone->config;
+  bsp_audio_output_config_t output_cfg = {.i2s_num = config->i2s_num};
+#if TDM_SLOTS > 0
+  i2s_tdm_config_t tdm_config = bsp_get_i2s_tdm_config(SAMPLE_RATE, BIT_DEPTH, TDM_SLOTS);
+  tdm_config.gpio_cfg.mclk = GPIO_NUM_NC;
+  tdm_config.gpio_cfg.bclk = config->bclk;
+  tdm_config.gpio_cfg.ws = config->ws;
+  tdm_config.gpio_cfg.dout = config->dout;
+  tdm_config.gpio_cfg.din = GPIO_NUM_NC;
+  output_cfg.tdm_cfg = &tdm_config;
+#else
+  i2s_std_config_t std_config = bsp_get_i2s_duplex_config(SAMPLE_RATE, BIT_DEPTH, CHANNEL_COUNT);
+  std_config.gpio_cfg.mclk = GPIO_NUM_NC;
+  std_config.gpio_cfg.bclk = config->bclk;
+  std_config.gpio_cfg.ws = config->ws;
+  std_config.gpio_cfg.dout = config->dout;
+  std_config.gpio_cfg.din = GPIO_NUM_NC;
+  output_cfg.std_cfg = &std_config;
+#endif
+  esp_err_t ret = bsp_audio_output_create(&output_cfg, &zone->output);
+  zone->tx_handle = bsp_audio_output_get_tx_handle(zone->output);
+  return ret;
+}
+
+// Delete a receiver of a zone (if any); false if its tasks could not be reaped
+static bool zone_receiver_delete(vban_handle_t* receiver) {
+  if (*receiver && vban_receiver_delete(*receiver) != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to delete the VBAN receiver, keeping its arena");
+    return false;
   }
+  *receiver = NULL;
+  return true;
+}
 
-  while (1) {
-    if (xQueueReceive(audio_queue, &audio_buf, portMAX_DELAY) == pdPASS) {
-      size_t bytes_written = 0;
-      esp_err_t ret = i2s_channel_write(tx_handle, audio_buf.buffer, audio_buf.size, &bytes_written, portMAX_DELAY);
-      if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "[writer] i2s write failed");
-        abort();
-      }
-      if (bytes_written != audio_buf.size) {
-        ESP_LOGW(TAG, "[writer] %d bytes should be written but only %d bytes are written", audio_buf.size, bytes_written);
-      }
+// Release what zone_start() created before it failed. The arena is kept if a receiver could not be deleted, since
+// its tasks may still be running on the arena's memory.
+static void zone_release(zone_t* zone) {
+  bool deleted = true;
+#if MIX_STREAMS > 1
+  stream_mixer_deinit(&zone->mixer);  // Its buffers and worker stack are in the arena
+  for (int i = 0; i < MIX_STREAMS - 1; i++) {
+    deleted &= zone_receiver_delete(&zone->mix_inputs[i]);
+  }
+#endif
+  deleted &= zone_receiver_delete(&zone->receiver);
+  if (deleted && zone->arena) {
+    vban_arena_delete(zone->arena);
+    zone->arena = NULL;
+  }
+}
+
+// Create and start a receiver for one stream of a zone, from the zone's arena. On failure the created receiver is
+// left in *receiver for zone_release().
+static esp_err_t zone_receiver_start(zone_t* zone, const zone_config_t* stream, vban_handle_t* receiver) {
+  const zone_config_t* config = zone->config;
+  vban_receiver_config_t receiver_cfg = {0};
+  receiver_cfg.arena = zone->arena;
+  strncpy(receiver_cfg.expected_stream_name, stream->stream_name, VBAN_STREAM_NAME_MAX_LEN - 1);
+  receiver_cfg.listen_port = stream->port;
+  // The receiver buffers the stream itself and converts it to the I2S format; the writer task pulls from it
+  receiver_cfg.pull_enabled = true;
+  receiver_cfg.pull_format.sample_rate_idx = vban_get_index_from_sr(SAMPLE_RATE);
+  receiver_cfg.pull_format.num_channels = CHANNEL_COUNT;
+  receiver_cfg.pull_format.data_type = OUTPUT_DATA_TYPE;  // Converted straight into the I2S sample format
+
+  // Two-stage pipeline: the network side (receive, validate, sequence) runs on one core, conversion into the pull
+  // ring on the output core next to the I2S writer
+  receiver_cfg.core_id = 1 - config->output_core;
+  receiver_cfg.task_priority = 5;
+  receiver_cfg.task_stack_size = VBAN_DEFAULT_TASK_STACK_SIZE;  // Taken from the arena (or set task_stack to supply it)
+  receiver_cfg.staged = true;
+  receiver_cfg.discovery_enabled = true;  // Lists the streams on the port in the report below
+  receiver_cfg.metering_enabled = true;   // Levels measured by the conversion loop, also shown in the stream list
+  // Silent streams are dropped before conversion after SILENCE_GATE_MS, and the writer mutes the amplifier
+  receiver_cfg.silence_gate_ms = SILENCE_GATE_MS;
+  receiver_cfg.silence_threshold = SILENCE_THRESHOLD;
+  receiver_cfg.stage2_core_id = config->output_core;
+
+  *receiver = vban_receiver_create(&receiver_cfg);
+  if (!*receiver) {
+    ESP_LOGE(TAG, "Failed to create VBAN receiver");
+    return ESP_FAIL;
+  }
+
+  esp_err_t err = vban_receiver_start(*receiver);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to start VBAN receiver: %s", esp_err_to_name(err));
+    return err;
+  }
+  ESP_LOGI(TAG, "VBAN Receiver initialized and started. Listening for stream '%s' on port %d.", stream->stream_name, stream->port);
+  return ESP_OK;
+}
+
+// Create and start the receive pipeline of a zone and its I2S writer
+static esp_err_t zone_start(zone_t* zone) {
+  const zone_config_t* config = zone->config;
+
+  // Everything the receivers own is carved from this arena, so streaming does not touch the heap
+  zone->arena = vban_arena_create(PIPELINE_ARENA_SIZE * MIX_STREAMS, NULL);
+  if (!zone->arena) {
+    ESP_LOGE(TAG, "Failed to create pipeline arena");
+    return ESP_ERR_NO_MEM;
+  }
+
+  // Output processing stages, run by the writer on every block it hands to I2S; the block comes from the arena too
+  esp_err_t err = dsp_chain_init(&zone->dsp_chain, CHANNEL_COUNT, DSP_BLOCK_FRAMES, zone->arena);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to initialize the output processing chain: %s", esp_err_to_name(err));
+    zone_release(zone);
+    return err;
+  }
+#if CONFIG_VBAN_DEMO_EQ
+  biquad_eq_init(&zone->eq, CHANNEL_COUNT);
+  biquad_coeffs_t coeffs[EQ_SECTIONS];
+  for (size_t i = 0; i < EQ_SECTIONS; i++) {
+    biquad_design(s_eq_bands[i].type, SAMPLE_RATE, s_eq_bands[i].freq, s_eq_bands[i].q, s_eq_bands[i].gain_db, &coeffs[i]);
+  }
+  biquad_eq_set_sections(&zone->eq, -1, coeffs, EQ_SECTIONS);  // Can be called again at any time, e.g. from a control task
+  dsp_chain_add_eq(&zone->dsp_chain, &zone->eq);
+#endif
+
+  err = zone_receiver_start(zone, config, &zone->receiver);
+  if (err != ESP_OK) {
+    zone_release(zone);
+    return err;
+  }
+  TaskFunction_t writer = i2s_writer;
+
+#if MIX_STREAMS > 1
+  // Mix the streams of the following zone configurations into this zone; the worker takes the network core, where
+  // the receivers' first stages run
+  const stream_mixer_config_t mixer_cfg = {
+      .data_type = OUTPUT_DATA_TYPE,
+      .num_channels = CHANNEL_COUNT,
+      .block_frames = MIX_BLOCK_FRAMES,
+      .worker_core_id = 1 - config->output_core,
+      .worker_priority = 5,
+      .worker_stack_size = MIX_WORKER_STACK_SIZE,
+      .arena = zone->arena,
+  };
+  err = stream_mixer_init(&zone->mixer, &mixer_cfg);
+  if (err == ESP_OK) {
+    err = stream_mixer_add_stream(&zone->mixer, zone->receiver, 1.0f / MIX_STREAMS);  // Full-scale inputs cannot clip the sum
+  }
+  for (int i = 0; i < MIX_STREAMS - 1 && err == ESP_OK; i++) {
+    err = zone_receiver_start(zone, &s_zone_configs[i + 1], &zone->mix_inputs[i]);
+    if (err == ESP_OK) {
+      err = stream_mixer_add_stream(&zone->mixer, zone->mix_inputs[i], 1.0f / MIX_STREAMS);
     }
   }
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to set up the stream mixer: %s", esp_err_to_name(err));
+    zone_release(zone);
+    return err;
+  }
+  writer = i2s_mix_writer;
+#endif
+
+  zone->writer_task = xTaskCreateStaticPinnedToCore(writer, "i2s_writer", WRITER_STACK_SIZE, zone, 5, zone->writer_stack, &zone->writer_tcb,
+                                                    config->output_core);
+  ESP_LOGI(TAG, "Pipeline arena: %d of %d bytes used", (int)vban_arena_get_used(zone->arena), PIPELINE_ARENA_SIZE * MIX_STREAMS);
+  return ESP_OK;
 }
 
-void app_main(void) {
-  esp_err_t ret = ESP_OK;
+// Level on the meter's 16-bit scale in dBFS (silence reads -96 dBFS, the floor of 16-bit audio)
+static float level_to_dbfs(uint16_t level) { return level > 0 ? 20.0f * log10f((float)level / LEVEL_METER_FULL_SCALE) : -96.0f; }
 
-  // --- Initialize circular buffer ---
-  ret = circular_buffer_init(&cb, VBAN_MAX_PAYLOAD_SIZE * 2);
-  if (ret != CB_SUCCESS) {
-    ESP_LOGE(TAG, "Failed to initialize circular buffer");
-    abort();
+// Report stack headroom and processing cost of a zone
+static void zone_report(zone_t* zone) {
+  vban_handle_t receiver_handle = zone->receiver;
+  TaskHandle_t writer_task = zone->writer_task;
+  vban_receiver_stats_t stats;
+  if (vban_receiver_get_stats(receiver_handle, &stats) == ESP_OK) {
+    ESP_LOGI(TAG, "Stack free (min): receiver %u bytes, writer %u bytes", (unsigned)stats.task_stack_free_min,
+             (unsigned)uxTaskGetStackHighWaterMark(writer_task));
+    const char* pull_path = stats.pull_path == VBAN_PULL_PATH_PASSTHROUGH ? "passthrough"
+                            : stats.pull_path == VBAN_PULL_PATH_CONVERT   ? "conversion"
+                                                                          : "none";
+    ESP_LOGI(TAG, "Pull path: %s (%u packets passed through unconverted)", pull_path, (unsigned)stats.passthrough_packets);
+    if (SILENCE_GATE_MS > 0) {
+      ESP_LOGI(TAG, "Silence gate: %u of %u packets dropped unconverted while idle, idled %u times", (unsigned)stats.gate_idle_packets,
+               (unsigned)stats.packets_accepted, (unsigned)stats.gate_closes);
+    }
+    if (stats.packets_accepted > 0) {
+      ESP_LOGI(TAG, "Processing: %u cycles per packet on average, %u cycles per batch at most",
+               (unsigned)(stats.process_cycles / stats.packets_accepted), (unsigned)stats.process_cycles_max);
+#if CONFIG_VBAN_FIXED_FORMAT
+      ESP_LOGI(TAG, "Specialized path: %u of %u packets", (unsigned)stats.fast_path_packets, (unsigned)stats.packets_accepted);
+#endif
+      ESP_LOGI(TAG, "Stage 2: %u cycles per packet on average, %u cycles per batch at most (%u packets dropped between stages)",
+               (unsigned)(stats.stage2_cycles / stats.packets_accepted), (unsigned)stats.stage2_cycles_max, (unsigned)stats.stage_drops);
+    }
   }
+  vban_stream_info_t streams[VBAN_DISCOVERY_MAX_STREAMS];
+  size_t num_streams = 0;
+  if (vban_receiver_get_streams(receiver_handle, streams, VBAN_DISCOVERY_MAX_STREAMS, &num_streams) == ESP_OK) {
+    for (size_t i = 0; i < num_streams; i++) {
+      const vban_stream_info_t* s = &streams[i];
+      const uint8_t* ip = (const uint8_t*)&s->sender_id;  // Network byte order
+      ESP_LOGI(TAG, "Stream '%s' from %u.%u.%u.%u:%u: %u ch, type %d, rate index %d, %u packets/s, %u of %u packets lost", s->stream_name,
+               ip[0], ip[1], ip[2], ip[3], (unsigned)s->sender_port, (unsigned)s->format.num_channels, (int)s->format.data_type,
+               (int)s->format.sample_rate_idx, (unsigned)s->packet_rate, (unsigned)s->lost, (unsigned)s->packets);
+    }
+  }
+  level_meter_levels_t levels;
+  if (vban_receiver_get_levels(receiver_handle, &levels) == ESP_OK) {
+    ESP_LOGI(TAG, "Levels: peak %.1f dBFS, RMS %.1f dBFS, %u clipped samples", level_to_dbfs(levels.peak), level_to_dbfs(levels.rms),
+             (unsigned)levels.clips);
+  }
+#if MIX_STREAMS > 1
+  for (size_t i = 0; i < zone->mixer.num_streams; i++) {
+    if (stream_mixer_get_levels(&zone->mixer, i, &levels) == ESP_OK) {
+      ESP_LOGI(TAG, "Mix input '%s': peak %.1f dBFS, RMS %.1f dBFS after the gain, %u blocks padded with silence",
+               s_zone_configs[i].stream_name, level_to_dbfs(levels.peak), level_to_dbfs(levels.rms),
+               (unsigned)zone->mixer.streams[i].underruns);
+    }
+  }
+#endif
+  for (size_t i = 0; i < zone->dsp_chain.num_stages; i++) {
+    dsp_stage_stats_t stage;
+    if (dsp_chain_get_stats(&zone->dsp_chain, i, &stage) == ESP_OK && stage.frames > 0) {
+      ESP_LOGI(TAG, "DSP stage '%s': %.1f cycles per sample, %u cycles per block at most, %u frames latency", stage.name,
+               (double)stage.cycles / (stage.frames * CHANNEL_COUNT), (unsigned)stage.cycles_max, (unsigned)stage.latency_frames);
+    }
+  }
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  // The writer does nothing but copy frames from the pull ring into the I2S DMA buffers (inside i2s_channel_write()),
+  // so its CPU time is the cost of that final copy, i.e. what a DMA-driven output path saves
+  uint32_t audio_ms = zone->writer_frames / (SAMPLE_RATE / 1000);
+  if (audio_ms > 0) {
+    ESP_LOGI(TAG, "I2S writer: %u us of CPU per second of audio",
+             (unsigned)((uint64_t)ulTaskGetRunTimeCounter(writer_task) * 1000 / audio_ms));
+  }
+#endif
+}
+
+void app_main(void) {
+  esp_err_t ret = ESP_OK;
 
   // --- Initialize audio ---
 
+#if TDM_SLOTS > 0
+  // TDM output to external multichannel amplifiers on the I2S pins; the ES8311 codec is not a TDM device and stays idle
+  // (zone 0 drives the board's I2S pins, further zones their own pins)
+  for (int slot = 0; slot < TDM_SLOTS; slot++) {
+    s_tdm_map[slot] = (int8_t)(slot % CHANNEL_COUNT);
+  }
+  i2s_tdm_config_t tdm_config = bsp_get_i2s_tdm_config(SAMPLE_RATE, BIT_DEPTH, TDM_SLOTS);
+  ret = bsp_audio_init_tdm(&tdm_config);
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Failed to initialize I2S in TDM mode");
+    abort();
+  }
+#else
   // I2S initialization
   i2s_std_config_t i2s_config = bsp_get_i2s_duplex_config(SAMPLE_RATE, BIT_DEPTH, CHANNEL_COUNT);
   ret = bsp_audio_init(&i2s_config);
@@ -154,15 +503,7 @@ void app_main(void) {
     ESP_LOGE(TAG, "Failed to open speaker codec");
     abort();
   }
-
-  // Create FreeRTOS queue
-  audio_queue = xQueueCreate(AUDIO_BUFFER_QUEUE_COUNT, sizeof(audio_buffer_t));
-  if (!audio_queue) {
-    ESP_LOGE(TAG, "Failed to create audio queue");
-    abort();
-  }
-
-  xTaskCreate(i2s_writer, "i2s_writer", 4096, NULL, 5, NULL);
+#endif
 
   // --- Initialize network ---
 
@@ -187,32 +528,47 @@ void app_main(void) {
     return;
   }
 
-  // --- Initialize VBAN ---
+  // --- Initialize VBAN zones ---
 
-  vban_receiver_config_t receiver_cfg = {0};
-  strncpy(receiver_cfg.expected_stream_name, VBAN_EXPECTED_STREAM, VBAN_STREAM_NAME_MAX_LEN - 1);
-  receiver_cfg.listen_port = VBAN_LISTEN_PORT;
-  receiver_cfg.audio_callback = vban_receive_callback;
-
-  // Set parameters for the receiving task (unnecessary if using default values in vban.c)
-  receiver_cfg.core_id = tskNO_AFFINITY;  // Run on any core
-  receiver_cfg.task_priority = 5;
-  receiver_cfg.task_stack_size = 4096;
-
-  vban_handle_t receiver_handle = vban_receiver_create(&receiver_cfg);
-  if (!receiver_handle) {
-    ESP_LOGE(TAG, "Failed to create VBAN receiver");
-    vTaskDelete(NULL);
-    return;
+  for (int z = 0; z < NUM_ZONES; z++) {
+    zone_t* zone = &s_zones[z];
+    zone->config = &s_zone_configs[z];
+    zone->has_amp = z == 0 && TDM_SLOTS == 0;  // The codec's amplifier is on once the speaker is opened
+    zone->amp_on = zone->has_amp;
+    if (z == 0) {
+      bsp_audio_get_i2s_handle(&zone->tx_handle, NULL);
+    } else {
+      ret = zone_output_create(zone);
+      if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize the I2S output of zone %d: %s", z, esp_err_to_name(ret));
+        continue;
+      }
+    }
+    if (!zone->tx_handle) {
+      ESP_LOGE(TAG, "Failed to get the I2S handle of zone %d", z);
+      continue;
+    }
+    ret = zone_start(zone);
+    if (ret != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to start zone %d", z);
+      if (zone->output) {
+        bsp_audio_output_delete(zone->output);
+        zone->output = NULL;
+        zone->tx_handle = NULL;
+      }
+    }
   }
 
-  esp_err_t err = vban_receiver_start(receiver_handle);
-  if (err != ESP_OK) {
-    ESP_LOGE(TAG, "Failed to start VBAN receiver: %s", esp_err_to_name(err));
-    vban_receiver_delete(receiver_handle);
-    vTaskDelete(NULL);
-    return;
-  }
+  // Setup is complete: from now on the streaming tasks must not allocate (checked with CONFIG_VBAN_ALLOC_GUARD)
+  alloc_guard_arm(true);
 
-  ESP_LOGI(TAG, "VBAN Receiver initialized and started. Listening for stream '%s' on port %d.", VBAN_EXPECTED_STREAM, VBAN_LISTEN_PORT);
-}
\ No newline at end of file
+  // Report stack headroom and processing cost once the pipelines have been streaming for a while, to tune the stack
+  // sizes above and to compare build profiles
+  vTaskDelay(pdMS_TO_TICKS(10000));
+  for (int z = 0; z < NUM_ZONES; z++) {
+    if (s_zones[z].receiver) {
+      ESP_LOGI(TAG, "Zone %d (I2S%d, stream '%s'):", z, s_zone_configs[z].i2s_num, s_zone_configs[z].stream_name);
+      zone_report(&s_zones[z]);
+    }
+  }
+}
@@ -8,6 +8,7 @@
 #include "driver/gpio.h"
 #include "driver/i2c_master.h"
 #include "driver/i2s_std.h"
+#include "driver/i2s_tdm.h"
 #include "esp_check.h"
 #include "esp_codec_dev.h"
 #include "esp_codec_dev_defaults.h"  // For ES8311 default address and interfaces
@@ -22,9 +23,14 @@ static bool i2c_initialized = false;
 static i2c_master_bus_handle_t i2c_handle = NULL;
 
 // I2S related variables
-static i2s_chan_handle_t i2s_tx_chan = NULL;
-static i2s_chan_handle_t i2s_rx_chan = NULL;
-static const audio_codec_data_if_t *i2s_data_if = NULL; /* Codec data interface */
+struct bsp_audio_output_s {
+  int i2s_num;
+  i2s_chan_handle_t tx_chan;
+  i2s_chan_handle_t rx_chan;  // NULL unless created duplex
+};
+static struct bsp_audio_output_s outputs[BSP_AUDIO_MAX_OUTPUTS];  // One per I2S controller, in use while tx_chan is set
+static bsp_audio_output_handle_t default_output = NULL;          // Output of bsp_audio_init(), wired to the codec
+static const audio_codec_data_if_t *i2s_data_if = NULL;           /* Codec data interface */
 
 i2s_std_config_t bsp_get_i2s_duplex_config(uint32_t sample_rate, uint8_t bit_depth, uint8_t channels) {
   if (channels < 1 || channels > 2) {
@@ -73,6 +79,54 @@ i2s_std_config_t bsp_get_i2s_duplex_config(uint32_t sample_rate, uint8_t bit_dep
   };
 }
 
+i2s_tdm_config_t bsp_get_i2s_tdm_config(uint32_t sample_rate, uint8_t bit_depth, uint8_t slots) {
+  if (slots != 4 && slots != 8 && slots != BSP_I2S_TDM_MAX_SLOTS) {
+    ESP_LOGE(TAG, "Invalid number of TDM slots: %d, using 8 as default", slots);
+    slots = 8;  // Default to 8 slots if invalid
+  }
+
+  i2s_data_bit_width_t data_bit_width;
+  switch (bit_depth) {
+    case 16:
+      data_bit_width = I2S_DATA_BIT_WIDTH_16BIT;
+      break;
+    case 24:
+      data_bit_width = I2S_DATA_BIT_WIDTH_24BIT;
+      break;
+    case 32:
+      data_bit_width = I2S_DATA_BIT_WIDTH_32BIT;
+      break;
+    default:
+      ESP_LOGE(TAG, "Unsupported TDM bit depth: %d, using 16-bit as default", bit_depth);
+      data_bit_width = I2S_DATA_BIT_WIDTH_16BIT;  // Default to 16-bit
+  }
+
+  i2s_tdm_slot_config_t slot_cfg =
+      I2S_TDM_PHILIPS_SLOT_DEFAULT_CONFIG(data_bit_width, I2S_SLOT_MODE_STEREO, (i2s_tdm_slot_mask_t)((1u << slots) - 1));
+  if (bit_depth == 24) {
+    slot_cfg.slot_bit_width = I2S_SLOT_BIT_WIDTH_32BIT;  // 24-bit data in 32-bit slots
+  }
+
+  return (i2s_tdm_config_t){
+      .clk_cfg = I2S_TDM_CLK_DEFAULT_CONFIG(sample_rate),
+      .slot_cfg = slot_cfg,
+      .gpio_cfg =
+          (i2s_tdm_gpio_config_t){
+              .mclk = BSP_I2S_MCLK,
+              .bclk = BSP_I2S_SCLK,
+              .ws = BSP_I2S_LCLK,
+              .dout = BSP_I2S_DOUT,
+              .din = BSP_I2S_DSIN,
+              .invert_flags =
+                  {
+                      .mclk_inv = false,
+                      .bclk_inv = false,
+                      .ws_inv = false,
+                  },
+          },
+  };
+}
+
 esp_err_t bsp_i2c_init(void) {
   /* I2C was initialized before */
   if (i2c_initialized) {
@@ -117,76 +171,137 @@ i2c_master_bus_handle_t bsp_i2c_get_handle(void) {
   return i2c_handle;
 }
 
-esp_err_t bsp_audio_init(const i2s_std_config_t *i2s_config) {
-  if (i2s_tx_chan || i2s_rx_chan) {
-    ESP_LOGW(TAG, "Audio has been initialized already");
-    return ESP_OK;
-  }
+// Initialize one I2S channel in standard mode, or in TDM mode when tdm_cfg is set
+static esp_err_t bsp_audio_init_channel(i2s_chan_handle_t chan, const i2s_std_config_t *std_cfg, const i2s_tdm_config_t *tdm_cfg) {
+  return tdm_cfg ? i2s_channel_init_tdm_mode(chan, tdm_cfg) : i2s_channel_init_std_mode(chan, std_cfg);
+}
+
+esp_err_t bsp_audio_output_create(const bsp_audio_output_config_t *config, bsp_audio_output_handle_t *ret_output) {
+  ESP_RETURN_ON_FALSE(config && ret_output && (config->std_cfg == NULL) != (config->tdm_cfg == NULL), ESP_ERR_INVALID_ARG, TAG,
+                      "Invalid output configuration");
+  ESP_RETURN_ON_FALSE(config->i2s_num >= 0 && config->i2s_num < BSP_AUDIO_MAX_OUTPUTS, ESP_ERR_INVALID_ARG, TAG,
+                      "Invalid I2S controller %d", config->i2s_num);
+  struct bsp_audio_output_s *output = &outputs[config->i2s_num];
+  ESP_RETURN_ON_FALSE(output->tx_chan == NULL, ESP_ERR_INVALID_STATE, TAG, "I2S%d is already in use", config->i2s_num);
 
   /* Setup I2S peripheral */
-  i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(CONFIG_BSP_I2S_NUM, I2S_ROLE_MASTER);
+  i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(config->i2s_num, I2S_ROLE_MASTER);
   chan_cfg.auto_clear = true;  // Auto clear the legacy data in the DMA buffer
-  ESP_RETURN_ON_ERROR(i2s_new_channel(&chan_cfg, &i2s_tx_chan, &i2s_rx_chan), TAG, "I2S new channel failed");
-
-  /* Setup I2S channels */
-  const i2s_std_config_t std_cfg_default = bsp_get_i2s_duplex_config(22050, 16, 1);  // Default to 22.05 kHz, 16-bit, mono
-  const i2s_std_config_t *p_i2s_cfg = (i2s_config != NULL) ? i2s_config : &std_cfg_default;
+  ESP_RETURN_ON_ERROR(i2s_new_channel(&chan_cfg, &output->tx_chan, config->duplex ? &output->rx_chan : NULL), TAG,
+                      "I2S new channel failed");
 
   esp_err_t ret = ESP_OK;
-  if (i2s_tx_chan != NULL) {
-    ret = i2s_channel_init_std_mode(i2s_tx_chan, p_i2s_cfg);
+  if (output->tx_chan != NULL) {
+    ret = bsp_audio_init_channel(output->tx_chan, config->std_cfg, config->tdm_cfg);
     if (ret != ESP_OK) {
       ESP_LOGE(TAG, "Failed to initialize I2S Tx channel: %s", esp_err_to_name(ret));
       goto err_init_tx;
     }
-    ret = i2s_channel_enable(i2s_tx_chan);
+    ret = i2s_channel_enable(output->tx_chan);
     if (ret != ESP_OK) {
       ESP_LOGE(TAG, "Failed to enable I2S Tx channel: %s", esp_err_to_name(ret));
       goto err_enable_tx;
     }
   }
 
-  if (i2s_rx_chan != NULL) {
-    ret = i2s_channel_init_std_mode(i2s_rx_chan, p_i2s_cfg);
+  if (output->rx_chan != NULL) {
+    ret = bsp_audio_init_channel(output->rx_chan, config->std_cfg, config->tdm_cfg);
     if (ret != ESP_OK) {
       ESP_LOGE(TAG, "Failed to initialize I2S Rx channel: %s", esp_err_to_name(ret));
       goto err_init_rx;
     }
-    ret = i2s_channel_enable(i2s_rx_chan);
+    ret = i2s_channel_enable(output->rx_chan);
     if (ret != ESP_OK) {
       ESP_LOGE(TAG, "Failed to enable I2S Rx channel: %s", esp_err_to_name(ret));
       goto err_enable_rx;
     }
   }
 
-  /* Create I2S data interface for codec */
-  audio_codec_i2s_cfg_t i2s_data_cfg = {
-      .port = CONFIG_BSP_I2S_NUM,
-      .tx_handle = i2s_tx_chan,
-      .rx_handle = i2s_rx_chan,
-  };
-  i2s_data_if = audio_codec_new_i2s_data(&i2s_data_cfg);
-  ESP_RETURN_ON_FALSE(i2s_data_if, ESP_FAIL, TAG, "Failed to create I2S data interface");
-
-  ESP_LOGI(TAG, "Audio I2S initialized successfully (Tx:%p, Rx:%p)", i2s_tx_chan, i2s_rx_chan);
+  output->i2s_num = config->i2s_num;
+  *ret_output = output;
+  ESP_LOGI(TAG, "Audio output on I2S%d initialized successfully (Tx:%p, Rx:%p)", config->i2s_num, output->tx_chan, output->rx_chan);
   return ESP_OK;
 
 // Error handling labels
 err_enable_rx:
-  if (i2s_rx_chan) i2s_channel_disable(i2s_rx_chan);
+  if (output->rx_chan) i2s_channel_disable(output->rx_chan);
 err_init_rx:
   // No cleanup needed for channel initialization errors
 err_enable_tx:
-  if (i2s_tx_chan) i2s_channel_disable(i2s_tx_chan);
+  if (output->tx_chan) i2s_channel_disable(output->tx_chan);
 err_init_tx:
   // No cleanup needed for channel initialization errors
-  if (i2s_tx_chan || i2s_rx_chan) i2s_del_channel(i2s_tx_chan);  // Assuming tx/rx use same channel handle internally
-  i2s_tx_chan = NULL;
-  i2s_rx_chan = NULL;
+  if (output->rx_chan) i2s_del_channel(output->rx_chan);
+  if (output->tx_chan) i2s_del_channel(output->tx_chan);
+  output->tx_chan = NULL;
+  output->rx_chan = NULL;
   ESP_LOGE(TAG, "Failed to initialize I2S channels: %s", esp_err_to_name(ret));
   return ret;
 }
 
+esp_err_t bsp_audio_output_delete(bsp_audio_output_handle_t output) {
+  ESP_RETURN_ON_FALSE(output && output->tx_chan, ESP_ERR_INVALID_ARG, TAG, "Invalid output");
+  ESP_RETURN_ON_FALSE(output != default_output, ESP_ERR_INVALID_STATE, TAG, "The codec output cannot be deleted");
+
+  i2s_channel_disable(output->tx_chan);
+  i2s_del_channel(output->tx_chan);
+  if (output->rx_chan) {
+    i2s_channel_disable(output->rx_chan);
+    i2s_del_channel(output->rx_chan);
+  }
+  output->tx_chan = NULL;
+  output->rx_chan = NULL;
+  return ESP_OK;
+}
+
+i2s_chan_handle_t bsp_audio_output_get_tx_handle(bsp_audio_output_handle_t output) { return output ? output->tx_chan : NULL; }
+
+bsp_audio_output_handle_t bsp_audio_get_output(void) { return default_output; }
+
+// Shared by bsp_audio_init() and bsp_audio_init_tdm(): exactly one of std_cfg and tdm_cfg is set
+static esp_err_t bsp_audio_init_default(const i2s_std_config_t *std_cfg, const i2s_tdm_config_t *tdm_cfg) {
+  if (default_output) {
+    ESP_LOGW(TAG, "Audio has been initialized already");
+    return ESP_OK;
+  }
+
+  const bsp_audio_output_config_t output_cfg = {
+      .i2s_num = CONFIG_BSP_I2S_NUM,
+      .std_cfg = std_cfg,
+      .tdm_cfg = tdm_cfg,
+      .duplex = true,  // The codec data interface uses both directions
+  };
+  bsp_audio_output_handle_t output = NULL;
+  ESP_RETURN_ON_ERROR(bsp_audio_output_create(&output_cfg, &output), TAG, "Failed to create the codec output");
+
+  /* Create I2S data interface for codec */
+  audio_codec_i2s_cfg_t i2s_data_cfg = {
+      .port = CONFIG_BSP_I2S_NUM,
+      .tx_handle = output->tx_chan,
+      .rx_handle = output->rx_chan,
+  };
+  i2s_data_if = audio_codec_new_i2s_data(&i2s_data_cfg);
+  if (!i2s_data_if) {
+    ESP_LOGE(TAG, "Failed to create I2S data interface");
+    bsp_audio_output_delete(output);  // Not the default output yet, so it can be deleted
+    return ESP_FAIL;
+  }
+
+  default_output = output;
+  return ESP_OK;
+}
+
+esp_err_t bsp_audio_init(const i2s_std_config_t *i2s_config) {
+  /* Setup I2S channels */
+  const i2s_std_config_t std_cfg_default = bsp_get_i2s_duplex_config(22050, 16, 1);  // Default to 22.05 kHz, 16-bit, mono
+  return bsp_audio_init_default((i2s_config != NULL) ? i2s_config : &std_cfg_default, NULL);
+}
+
+esp_err_t bsp_audio_init_tdm(const i2s_tdm_config_t *i2s_config) {
+  ESP_RETURN_ON_FALSE(i2s_config, ESP_ERR_INVALID_ARG, TAG, "TDM configuration is NULL");
+  return bsp_audio_init_default(NULL, i2s_config);
+}
+
 // Helper function to initialize common codec components
 static esp_err_t bsp_codec_init_interfaces(const audio_codec_ctrl_if_t **ctrl_if, const audio_codec_gpio_if_t **gpio_if) {
   esp_err_t ret;
@@ -308,7 +423,11 @@ esp_codec_dev_handle_t bsp_audio_codec_microphone_init(void) {
   return mic_handle;
 }
 
+esp_err_t bsp_audio_power_amp_enable(bool enable) {
+  return gpio_set_level(BSP_POWER_AMP_IO, enable ? 1 : 0);  // Active high (pa_reverted is false)
+}
+
 void bsp_audio_get_i2s_handle(i2s_chan_handle_t *tx, i2s_chan_handle_t *rx) {
-  if (tx) *tx = i2s_tx_chan;
-  if (rx) *rx = i2s_rx_chan;
+  if (tx) *tx = default_output ? default_output->tx_chan : NULL;
+  if (rx) *rx = default_output ? default_output->rx_chan : NULL;
 }
\ No newline at end of file
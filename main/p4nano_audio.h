@@ -8,6 +8,7 @@
 #include "driver/gpio.h"
 #include "driver/i2c_master.h"
 #include "driver/i2s_std.h"
+#include "driver/i2s_tdm.h"
 #include "esp_codec_dev.h"
 #include "sdkconfig.h"
 
@@ -37,6 +38,10 @@ extern "C" {
 #define CONFIG_BSP_I2C_NUM 0
 /* I2S peripheral index -> [0,1,2] ESP32P4 has three I2S peripherals, pick the one you want to use. */
 #define CONFIG_BSP_I2S_NUM 0
+/* Audio outputs -> one per I2S peripheral (see bsp_audio_output_create()) */
+#define BSP_AUDIO_MAX_OUTPUTS 3
+/* Largest TDM frame of bsp_get_i2s_tdm_config() */
+#define BSP_I2S_TDM_MAX_SLOTS 16
 
 /**
  * @brief Init I2C driver
@@ -74,6 +79,65 @@ i2c_master_bus_handle_t bsp_i2c_get_handle(void);
  *
  **************************************************************************************************/
 
+/**
+ * @brief Audio output on one I2S peripheral, e.g. one zone of a multi-zone installation
+ */
+typedef struct bsp_audio_output_s *bsp_audio_output_handle_t;
+
+/**
+ * @brief Configuration of an audio output
+ */
+typedef struct {
+  int i2s_num;                      /**< I2S peripheral (0 to BSP_AUDIO_MAX_OUTPUTS - 1) */
+  const i2s_std_config_t *std_cfg;  /**< Standard mode configuration, pins included (NULL when tdm_cfg is set) */
+  const i2s_tdm_config_t *tdm_cfg;  /**< TDM mode configuration, pins included (NULL when std_cfg is set) */
+  bool duplex;                      /**< Also create the Rx channel of the peripheral */
+} bsp_audio_output_config_t;
+
+/**
+ * @brief Create an audio output on one I2S peripheral
+ *
+ * Each output owns its I2S channels, so several outputs (one per peripheral, on their own pins) play independently.
+ * bsp_audio_init() creates the output wired to the onboard codec; outputs created here drive external DACs or
+ * amplifiers on the pins of their configuration.
+ *
+ * @param[in]  config     Output configuration
+ * @param[out] ret_output Created output
+ * @return
+ * - ESP_OK                On success
+ * - ESP_ERR_INVALID_ARG   NULL pointer or invalid configuration
+ * - ESP_ERR_INVALID_STATE The I2S peripheral is already used by another output
+ * - ESP_ERR_NOT_FOUND     No available I2S channel found
+ * - ESP_ERR_NO_MEM        No memory for storing the channel information
+ */
+esp_err_t bsp_audio_output_create(const bsp_audio_output_config_t *config, bsp_audio_output_handle_t *ret_output);
+
+/**
+ * @brief Stop an audio output and delete its I2S channels
+ *
+ * @param[in] output Output created by bsp_audio_output_create()
+ * @return
+ * - ESP_OK                On success
+ * - ESP_ERR_INVALID_ARG   Invalid output
+ * - ESP_ERR_INVALID_STATE The output is the codec output of bsp_audio_init()
+ */
+esp_err_t bsp_audio_output_delete(bsp_audio_output_handle_t output);
+
+/**
+ * @brief Get the I2S transmit channel of an audio output
+ *
+ * @param[in] output Audio output
+ * @return I2S transmit channel handle, or NULL for an invalid output
+ */
+i2s_chan_handle_t bsp_audio_output_get_tx_handle(bsp_audio_output_handle_t output);
+
+/**
+ * @brief Get the audio output wired to the onboard codec
+ *
+ * @return Output created by bsp_audio_init() or bsp_audio_init_tdm(), or NULL if audio is not initialized
+ */
+bsp_audio_output_handle_t bsp_audio_get_output(void);
+
 /**
  * @brief Init audio
  *
@@ -93,12 +157,42 @@ esp_err_t bsp_audio_init(const i2s_std_config_t *i2s_config);
  * @brief Get I2S configuration for duplex mode
  *
  * @param[in] sample_rate Sample rate for the I2S configuration
- * @param[in] bit_depth   Bit depth for the I2S configuration (e.g., 8, 16, 24, 32)
+ * @param[in] bit_depth   Bit depth for the I2S configuration (e.g., 8, 16, 24, 32). High-resolution output uses 32: the
+ *                        slots match the data, and the ES8311 resolves the top 24 bits of each left-justified sample
  * @param[in] channels    Number of channels (1 for mono, 2 for stereo)
  * @return Configured I2S standard configuration
  */
 i2s_std_config_t bsp_get_i2s_duplex_config(uint32_t sample_rate, uint8_t bit_depth, uint8_t channels);
 
+/**
+ * @brief Init audio in TDM mode
+ *
+ * Same as bsp_audio_init(), with the channels in TDM mode. The onboard ES8311 is a stereo codec and does not take
+ * TDM frames: the slots are meant for external multichannel DACs or amplifiers on the I2S pins.
+ *
+ * @param[in]  i2s_config I2S TDM configuration (see bsp_get_i2s_tdm_config())
+ * @return
+ * - ESP_OK                On success
+ * - ESP_ERR_INVALID_ARG   NULL pointer or invalid configuration
+ * - ESP_ERR_NOT_FOUND     No available I2S channel found
+ * - ESP_ERR_NO_MEM        No memory for storing the channel information
+ * - ESP_ERR_INVALID_STATE This channel has not initialized or already started
+ */
+esp_err_t bsp_audio_init_tdm(const i2s_tdm_config_t *i2s_config);
+
+/**
+ * @brief Get I2S configuration for TDM mode
+ *
+ * Every slot of the frame is active; slot i carries channel i of the interleaved frames written to the channel
+ * (see pcm_route() to build them). 24-bit data is sent in 32-bit slots.
+ *
+ * @param[in] sample_rate Sample rate for the I2S configuration
+ * @param[in] bit_depth   Bit depth of each slot (16, 24 or 32)
+ * @param[in] slots       Number of slots per frame (4, 8 or 16)
+ * @return Configured I2S TDM configuration
+ */
+i2s_tdm_config_t bsp_get_i2s_tdm_config(uint32_t sample_rate, uint8_t bit_depth, uint8_t slots);
+
 /**
  * @brief Initialize speaker codec device
  *
@@ -115,6 +209,19 @@ esp_codec_dev_handle_t bsp_audio_codec_speaker_init(void);
  */
 esp_codec_dev_handle_t bsp_audio_codec_microphone_init(void);
 
+/**
+ * @brief Switch the speaker power amplifier (BSP_POWER_AMP_IO) on or off
+ *
+ * The codec driver configures the pin and switches the amplifier on when the speaker is opened. This switches it
+ * without closing the codec, e.g. to save power while only silence is played.
+ *
+ * @param[in] enable true to power the amplifier, false to mute it
+ * @return
+ * - ESP_OK On success
+ * - Others Error of the GPIO driver
+ */
+esp_err_t bsp_audio_power_amp_enable(bool enable);
+
 /**
  * @brief Get I2S channel handle
  *
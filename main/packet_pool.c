@@ -0,0 +1,166 @@
+#include "packet_pool.h"
+
+#include <stdint.h>  // For uintptr_t
+#include <stdlib.h>  // For malloc, free
+#include <string.h>  // For memset
+
+#include "hot_path.h"
+
+// Chunk header, followed by the buffers of the chunk (offset bytes past an alignment boundary)
+struct packet_pool_chunk_s {
+  packet_pool_chunk_t *next;
+  void *allocation;  // Start of the allocation, which may precede the aligned header
+};
+
+#define PACKET_POOL_ALIGN_UP(x, alignment) (((x) + (alignment) - 1) & ~(size_t)((alignment) - 1))
+
+esp_err_t packet_pool_init(packet_pool_t *pool, size_t buffer_size) {
+  if (!pool || buffer_size < sizeof(void *)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(pool, 0, sizeof(*pool));
+  pool->buffer_size = buffer_size;
+  pool->alignment = PACKET_POOL_ALIGNMENT;
+  pool->stride = PACKET_POOL_ALIGN_UP(buffer_size, PACKET_POOL_ALIGNMENT);
+  portMUX_INITIALIZE(&pool->lock);
+  return ESP_OK;
+}
+
+esp_err_t packet_pool_set_placement(packet_pool_t *pool, size_t alignment, size_t offset) {
+  if (!pool || alignment < PACKET_POOL_ALIGNMENT || (alignment & (alignment - 1)) != 0 || offset >= alignment ||
+      offset % sizeof(void *) != 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (pool->chunks) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  pool->alignment = alignment;
+  pool->offset = offset;
+  pool->stride = PACKET_POOL_ALIGN_UP(pool->buffer_size, alignment);  // Keeps every buffer at the same offset
+  return ESP_OK;
+}
+
+void packet_pool_set_allocator(packet_pool_t *pool, packet_pool_alloc_fn_t alloc, packet_pool_free_fn_t free, void *ctx) {
+  if (!pool) {
+    return;
+  }
+
+  pool->chunk_alloc = alloc;
+  pool->chunk_free = free;
+  pool->chunk_ctx = ctx;
+}
+
+void packet_pool_deinit(packet_pool_t *pool) {
+  if (!pool) {
+    return;
+  }
+
+  packet_pool_chunk_t *chunk = pool->chunks;
+  while (chunk) {
+    packet_pool_chunk_t *next = chunk->next;
+    if (!pool->chunk_alloc) {
+      free(chunk->allocation);
+    } else if (pool->chunk_free) {
+      pool->chunk_free(pool->chunk_ctx, chunk->allocation);
+    }
+    chunk = next;
+  }
+  pool->chunks = NULL;
+  pool->free_list = NULL;
+  pool->total = 0;
+  pool->available = 0;
+  pool->reserved = 0;
+}
+
+esp_err_t packet_pool_reserve(packet_pool_t *pool, size_t count) {
+  if (!pool) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  portENTER_CRITICAL(&pool->lock);
+  size_t missing = pool->reserved + count > pool->total ? pool->reserved + count - pool->total : 0;
+  if (missing == 0) {
+    pool->reserved += count;
+  }
+  portEXIT_CRITICAL(&pool->lock);
+  if (missing == 0) {
+    return ESP_OK;
+  }
+
+  // Allocate outside the critical section; the buffers are linked in afterwards
+  const size_t header_size = PACKET_POOL_ALIGN_UP(sizeof(packet_pool_chunk_t), pool->alignment);
+  const size_t size = pool->alignment + header_size + pool->offset + missing * pool->stride;
+  void *allocation = pool->chunk_alloc ? pool->chunk_alloc(pool->chunk_ctx, size) : malloc(size);
+  if (!allocation) {
+    return ESP_ERR_NO_MEM;
+  }
+  uint8_t *base = (uint8_t *)PACKET_POOL_ALIGN_UP((uintptr_t)allocation, pool->alignment);
+  packet_pool_chunk_t *chunk = (packet_pool_chunk_t *)base;
+  chunk->allocation = allocation;
+
+  uint8_t *buffers = base + header_size + pool->offset;
+  for (size_t i = 0; i + 1 < missing; i++) {
+    *(void **)(buffers + i * pool->stride) = buffers + (i + 1) * pool->stride;
+  }
+
+  portENTER_CRITICAL(&pool->lock);
+  chunk->next = pool->chunks;
+  pool->chunks = chunk;
+  *(void **)(buffers + (missing - 1) * pool->stride) = pool->free_list;
+  pool->free_list = buffers;
+  pool->total += missing;
+  pool->available += missing;
+  pool->reserved += count;
+  portEXIT_CRITICAL(&pool->lock);
+  return ESP_OK;
+}
+
+void packet_pool_unreserve(packet_pool_t *pool, size_t count) {
+  if (!pool) {
+    return;
+  }
+
+  portENTER_CRITICAL(&pool->lock);
+  pool->reserved = count < pool->reserved ? pool->reserved - count : 0;
+  portEXIT_CRITICAL(&pool->lock);
+}
+
+HOT_PATH_ATTR void *packet_pool_alloc(packet_pool_t *pool) {
+  if (!pool) {
+    return NULL;
+  }
+
+  portENTER_CRITICAL(&pool->lock);
+  void *buffer = pool->free_list;
+  if (buffer) {
+    pool->free_list = *(void **)buffer;
+    pool->available--;
+  }
+  portEXIT_CRITICAL(&pool->lock);
+  return buffer;
+}
+
+HOT_PATH_ATTR void packet_pool_free(packet_pool_t *pool, void *buffer) {
+  if (!pool || !buffer) {
+    return;
+  }
+
+  portENTER_CRITICAL(&pool->lock);
+  *(void **)buffer = pool->free_list;
+  pool->free_list = buffer;
+  pool->available++;
+  portEXIT_CRITICAL(&pool->lock);
+}
+
+size_t packet_pool_get_available(packet_pool_t *pool) {
+  if (!pool) {
+    return 0;
+  }
+
+  portENTER_CRITICAL(&pool->lock);
+  size_t available = pool->available;
+  portEXIT_CRITICAL(&pool->lock);
+  return available;
+}
@@ -0,0 +1,139 @@
+#ifndef PACKET_POOL_H_
+#define PACKET_POOL_H_
+
+#include <stddef.h>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"  // For portMUX_TYPE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PACKET_POOL_ALIGNMENT 16  // Default alignment of the buffers handed out by the pool (see packet_pool_set_placement())
+
+typedef struct packet_pool_chunk_s packet_pool_chunk_t;
+
+typedef void *(*packet_pool_alloc_fn_t)(void *ctx, size_t size);  // Chunk allocator, returns NULL on failure
+typedef void (*packet_pool_free_fn_t)(void *ctx, void *ptr);      // Chunk deallocator
+
+/**
+ * @brief Pool of fixed-size packet buffers
+ *
+ * Buffers are handed out and returned by pointer, so ownership of a received packet can move between
+ * stages without copying it. Users reserve the number of buffers they may hold at most; the pool grows
+ * (in chunks) only when a reservation cannot be covered by buffers returned earlier, so allocation
+ * happens at setup time and alloc/free never touch the heap. Alloc/free are safe from any task.
+ * Buffers start at a fixed offset from an alignment boundary (see packet_pool_set_placement()).
+ */
+typedef struct {
+  size_t buffer_size;                  /**< Usable size of each buffer in bytes */
+  size_t stride;                       /**< Distance between buffers (buffer_size rounded up to the alignment) */
+  size_t alignment;                    /**< Alignment boundary of the buffers (PACKET_POOL_ALIGNMENT by default) */
+  size_t offset;                       /**< Offset of every buffer from an alignment boundary (0 by default) */
+  void *free_list;                     /**< Intrusive singly-linked list of free buffers */
+  packet_pool_chunk_t *chunks;         /**< Allocated chunks, released by packet_pool_deinit() */
+  size_t total;                        /**< Buffers owned by the pool */
+  size_t available;                    /**< Buffers currently in the free list */
+  size_t reserved;                     /**< Buffers promised to users via packet_pool_reserve() */
+  portMUX_TYPE lock;                   /**< Protects the fields above */
+  packet_pool_alloc_fn_t chunk_alloc;  /**< Allocator of chunks (NULL for malloc/free) */
+  packet_pool_free_fn_t chunk_free;    /**< Deallocator of chunks (NULL if the allocator's memory is not freed) */
+  void *chunk_ctx;                     /**< Context passed to chunk_alloc/chunk_free */
+} packet_pool_t;
+
+/**
+ * @brief Initialize an empty pool
+ *
+ * @param pool Pointer to the pool structure
+ * @param buffer_size Size of each buffer in bytes (at least sizeof(void *))
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pool or buffer size too small
+ */
+esp_err_t packet_pool_init(packet_pool_t *pool, size_t buffer_size);
+
+/**
+ * @brief Take the chunks of the pool from a custom allocator (e.g. an arena) instead of the heap
+ * Must be called before the first reservation.
+ *
+ * @param pool Pointer to the pool structure
+ * @param alloc Chunk allocator
+ * @param free Chunk deallocator, or NULL if chunks are released with the allocator's memory
+ * @param ctx Context passed to alloc and free
+ */
+void packet_pool_set_allocator(packet_pool_t *pool, packet_pool_alloc_fn_t alloc, packet_pool_free_fn_t free, void *ctx);
+
+/**
+ * @brief Place every buffer at offset bytes past an alignment boundary instead of on PACKET_POOL_ALIGNMENT
+ * Lets data at a fixed position in the buffer (e.g. a payload after a header) land on the boundary.
+ * Must be called before the first reservation.
+ *
+ * @param pool Pointer to the pool structure
+ * @param alignment Alignment boundary, a power of two of at least PACKET_POOL_ALIGNMENT
+ * @param offset Offset from the boundary, a multiple of sizeof(void *) smaller than alignment
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pool, or invalid alignment or offset
+ * - ESP_ERR_INVALID_STATE: The pool already has buffers
+ */
+esp_err_t packet_pool_set_placement(packet_pool_t *pool, size_t alignment, size_t offset);
+
+/**
+ * @brief Release all memory of the pool
+ * All buffers must have been returned; pointers still held by users become invalid.
+ *
+ * @param pool Pointer to the pool structure
+ */
+void packet_pool_deinit(packet_pool_t *pool);
+
+/**
+ * @brief Guarantee that count more buffers can be allocated
+ * Grows the pool by one chunk if the unreserved buffers do not cover the request.
+ *
+ * @param pool Pointer to the pool structure
+ * @param count Number of buffers to reserve
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_NO_MEM: The pool could not grow
+ */
+esp_err_t packet_pool_reserve(packet_pool_t *pool, size_t count);
+
+/**
+ * @brief Give back a reservation made with packet_pool_reserve()
+ * The memory stays in the pool and covers later reservations.
+ *
+ * @param pool Pointer to the pool structure
+ * @param count Number of buffers to unreserve
+ */
+void packet_pool_unreserve(packet_pool_t *pool, size_t count);
+
+/**
+ * @brief Take a buffer from the pool
+ *
+ * @param pool Pointer to the pool structure
+ * @return Pointer to a buffer of buffer_size bytes, or NULL if the pool is empty
+ */
+void *packet_pool_alloc(packet_pool_t *pool);
+
+/**
+ * @brief Return a buffer to the pool
+ *
+ * @param pool Pointer to the pool structure
+ * @param buffer Buffer obtained from packet_pool_alloc() (NULL is ignored)
+ */
+void packet_pool_free(packet_pool_t *pool, void *buffer);
+
+/**
+ * @brief Get the number of free buffers
+ *
+ * @param pool Pointer to the pool structure
+ * @return Number of buffers currently available
+ */
+size_t packet_pool_get_available(packet_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PACKET_POOL_H_
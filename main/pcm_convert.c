@@ -0,0 +1,377 @@
+#include "pcm_convert.h"
+
+#include <math.h>    // For cosf, sinf
+#include <stdint.h>  // For uintptr_t
+#include <string.h>  // For memcpy
+
+#include "hot_path.h"
+
+// --- Sample readers ---
+// Integer samples are read as left-justified 32-bit values (Q31), float samples as float.
+// memcpy is used for loads so that unaligned payloads are handled; it compiles to plain loads.
+
+static inline int32_t pcm_read_q31_uint8(const uint8_t* p) { return (int32_t)((uint32_t)(p[0] ^ 0x80) << 24); }
+
+static inline int32_t pcm_read_q31_int16(const uint8_t* p) {
+  int16_t v;
+  memcpy(&v, p, sizeof(v));
+  return (int32_t)((uint32_t)(uint16_t)v << 16);
+}
+
+static inline int32_t pcm_read_q31_int24(const uint8_t* p) {
+  return (int32_t)(((uint32_t)p[0] << 8) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 24));
+}
+
+static inline int32_t pcm_read_q31_int32(const uint8_t* p) {
+  int32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline float pcm_read_float32(const uint8_t* p) {
+  float v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline float pcm_read_float64(const uint8_t* p) {
+  double v;
+  memcpy(&v, p, sizeof(v));
+  return (float)v;
+}
+
+// --- Sample writers ---
+
+static inline int16_t pcm_q31_to_int16(int32_t v) { return (int16_t)(v >> 16); }
+
+static inline float pcm_q31_to_float(int32_t v) { return (float)v * (1.0f / 2147483648.0f); }
+
+static inline int16_t pcm_float_to_int16(float v) {
+  float s = v * 32768.0f;
+  if (s >= 32767.0f) return INT16_MAX;
+  if (s <= -32768.0f) return INT16_MIN;
+  return (int16_t)s;
+}
+
+static inline int32_t pcm_float_to_q31(float v) {
+  // 2147483647.0f is not representable; clamp against 2^31 and saturate explicitly.
+  float s = v * 2147483648.0f;
+  if (s >= 2147483648.0f) return INT32_MAX;
+  if (s <= -2147483648.0f) return INT32_MIN;
+  return (int32_t)s;
+}
+
+// Generates one conversion loop per (reader, writer) pair so that no per-sample dispatch remains.
+// With a meter, the levels of the samples read are accumulated in registers by meter_fn and merged once at the end;
+// the kernels are instantiated with a constant NULL meter as well, where the metering folds away.
+#define PCM_CONVERT_LOOP(dst_ctype, read_fn, src_stride, write_expr, meter_fn) \
+  do {                                                                         \
+    dst_ctype* d = (dst_ctype*)dst;                                            \
+    const uint8_t* s = (const uint8_t*)src;                                    \
+    level_meter_acc_t acc = {0};                                               \
+    for (size_t i = 0; i < num_samples; i++, s += (src_stride)) {              \
+      const __typeof__(read_fn(s)) v = read_fn(s);                             \
+      d[i] = (write_expr);                                                     \
+      if (meter) meter_fn(&acc, v);                                            \
+    }                                                                          \
+    if (meter) level_meter_acc_merge(meter, &acc, num_samples);                \
+  } while (0)
+
+#define PCM_CONVERT_INT_SOURCE(read_fn, src_stride)                                             \
+  switch (dst_type) {                                                                           \
+    case VBAN_DATATYPE_INT16:                                                                   \
+      PCM_CONVERT_LOOP(int16_t, read_fn, src_stride, pcm_q31_to_int16(v), level_meter_acc_q31); \
+      return ESP_OK;                                                                            \
+    case VBAN_DATATYPE_INT32:                                                                   \
+      PCM_CONVERT_LOOP(int32_t, read_fn, src_stride, v, level_meter_acc_q31);                   \
+      return ESP_OK;                                                                            \
+    case VBAN_DATATYPE_FLOAT32:                                                                 \
+      PCM_CONVERT_LOOP(float, read_fn, src_stride, pcm_q31_to_float(v), level_meter_acc_q31);   \
+      return ESP_OK;                                                                            \
+    default:                                                                                    \
+      return ESP_ERR_NOT_SUPPORTED;                                                             \
+  }
+
+#define PCM_CONVERT_FLOAT_SOURCE(read_fn, src_stride)                                               \
+  switch (dst_type) {                                                                               \
+    case VBAN_DATATYPE_INT16:                                                                       \
+      PCM_CONVERT_LOOP(int16_t, read_fn, src_stride, pcm_float_to_int16(v), level_meter_acc_float); \
+      return ESP_OK;                                                                                \
+    case VBAN_DATATYPE_INT32:                                                                       \
+      PCM_CONVERT_LOOP(int32_t, read_fn, src_stride, pcm_float_to_q31(v), level_meter_acc_float);   \
+      return ESP_OK;                                                                                \
+    case VBAN_DATATYPE_FLOAT32:                                                                     \
+      PCM_CONVERT_LOOP(float, read_fn, src_stride, v, level_meter_acc_float);                       \
+      return ESP_OK;                                                                                \
+    default:                                                                                        \
+      return ESP_ERR_NOT_SUPPORTED;                                                                 \
+  }
+
+HOT_PATH_ATTR bool pcm_convert_is_output_supported(vban_data_type_t dst_type) {
+  return dst_type == VBAN_DATATYPE_INT16 || dst_type == VBAN_DATATYPE_INT32 || dst_type == VBAN_DATATYPE_FLOAT32;
+}
+
+// Conversion of num_samples samples, instantiated for sources of unknown alignment and for sources known to be
+// aligned, where the memcpy loads of the readers become plain word loads, each with and without a meter.
+static inline __attribute__((always_inline)) esp_err_t pcm_convert_kernel(void* dst, vban_data_type_t dst_type, const void* src,
+                                                                          vban_data_type_t src_type, size_t num_samples,
+                                                                          level_meter_acc_t* meter) {
+  switch (src_type) {
+    case VBAN_DATATYPE_UINT8:
+      PCM_CONVERT_INT_SOURCE(pcm_read_q31_uint8, 1);
+    case VBAN_DATATYPE_INT16:
+      PCM_CONVERT_INT_SOURCE(pcm_read_q31_int16, 2);
+    case VBAN_DATATYPE_INT24:
+      PCM_CONVERT_INT_SOURCE(pcm_read_q31_int24, 3);
+    case VBAN_DATATYPE_INT32:
+      PCM_CONVERT_INT_SOURCE(pcm_read_q31_int32, 4);
+    case VBAN_DATATYPE_FLOAT32:
+      PCM_CONVERT_FLOAT_SOURCE(pcm_read_float32, 4);
+    case VBAN_DATATYPE_FLOAT64:
+      PCM_CONVERT_FLOAT_SOURCE(pcm_read_float64, 8);
+    default:
+      // VBAN_DATATYPE_INT12 and VBAN_DATATYPE_INT10 are packed formats and not supported
+      return ESP_ERR_NOT_SUPPORTED;
+  }
+}
+
+// Select the instance of the kernel for the alignment of src and the presence of a meter
+static inline __attribute__((always_inline)) esp_err_t pcm_convert_dispatch(void* dst, vban_data_type_t dst_type, const void* src,
+                                                                            vban_data_type_t src_type, size_t num_samples,
+                                                                            level_meter_acc_t* meter) {
+  const bool aligned = ((uintptr_t)src & (PCM_CONVERT_ALIGNMENT - 1)) == 0;
+  if (meter) {
+    return aligned ? pcm_convert_kernel(dst, dst_type, __builtin_assume_aligned(src, PCM_CONVERT_ALIGNMENT), src_type, num_samples, meter)
+                   : pcm_convert_kernel(dst, dst_type, src, src_type, num_samples, meter);
+  }
+  return aligned ? pcm_convert_kernel(dst, dst_type, __builtin_assume_aligned(src, PCM_CONVERT_ALIGNMENT), src_type, num_samples, NULL)
+                 : pcm_convert_kernel(dst, dst_type, src, src_type, num_samples, NULL);
+}
+
+HOT_PATH_ATTR esp_err_t pcm_convert(void* dst, vban_data_type_t dst_type, const void* src, vban_data_type_t src_type, size_t num_samples) {
+  return pcm_convert_metered(dst, dst_type, src, src_type, num_samples, NULL);
+}
+
+HOT_PATH_ATTR esp_err_t pcm_convert_metered(void* dst, vban_data_type_t dst_type, const void* src, vban_data_type_t src_type,
+                                            size_t num_samples, level_meter_acc_t* meter) {
+  if ((!dst || !src) && num_samples > 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!pcm_convert_is_output_supported(dst_type)) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+
+  // Same representation: plain copy, or the identity kernel when metering (the samples are read once either way)
+  if (src_type == dst_type && !meter) {
+    memcpy(dst, src, num_samples * vban_get_data_type_size(dst_type));
+    return ESP_OK;
+  }
+
+  return pcm_convert_dispatch(dst, dst_type, src, src_type, num_samples, meter);
+}
+
+// --- Channel routing ---
+
+#define PCM_ROUTE_LOOP(ctype)                                                   \
+  do {                                                                          \
+    ctype* d = (ctype*)dst;                                                     \
+    const ctype* s = (const ctype*)src;                                         \
+    for (size_t f = 0; f < frames; f++, d += dst_channels, s += src_channels) { \
+      for (size_t c = 0; c < dst_channels; c++) {                               \
+        d[c] = map[c] < 0 ? 0 : s[map[c]];                                      \
+      }                                                                         \
+    }                                                                           \
+  } while (0)
+
+HOT_PATH_ATTR esp_err_t pcm_route(void* dst, size_t dst_channels, const void* src, size_t src_channels, const int8_t* map,
+                                  vban_data_type_t type, size_t frames) {
+  if ((!dst || !src || !map) && frames > 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (!pcm_convert_is_output_supported(type)) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+  for (size_t c = 0; c < dst_channels; c++) {  // Checked once, not per frame
+    if (map[c] >= (int)src_channels) {
+      return ESP_ERR_INVALID_ARG;
+    }
+  }
+
+  // Samples are moved, not interpreted: int32 and float share the 32-bit loop
+  if (vban_get_data_type_size(type) == sizeof(uint16_t)) {
+    PCM_ROUTE_LOOP(uint16_t);
+  } else {
+    PCM_ROUTE_LOOP(uint32_t);
+  }
+  return ESP_OK;
+}
+
+// --- Peak scan ---
+
+#define PCM_PEAK_LOOP(read_fn, src_stride, meter_fn)              \
+  do {                                                            \
+    const uint8_t* s = (const uint8_t*)src;                       \
+    for (size_t i = 0; i < num_samples; i++, s += (src_stride)) { \
+      meter_fn(&acc, read_fn(s));                                 \
+    }                                                             \
+  } while (0)
+
+HOT_PATH_ATTR uint32_t pcm_peak(const void* src, vban_data_type_t type, size_t num_samples) {
+  if (!src && num_samples > 0) {
+    return LEVEL_METER_FULL_SCALE;
+  }
+
+  level_meter_acc_t acc = {0};
+  switch (type) {
+    case VBAN_DATATYPE_UINT8:
+      PCM_PEAK_LOOP(pcm_read_q31_uint8, 1, level_meter_acc_q31);
+      break;
+    case VBAN_DATATYPE_INT16:
+      PCM_PEAK_LOOP(pcm_read_q31_int16, 2, level_meter_acc_q31);
+      break;
+    case VBAN_DATATYPE_INT24:
+      PCM_PEAK_LOOP(pcm_read_q31_int24, 3, level_meter_acc_q31);
+      break;
+    case VBAN_DATATYPE_INT32:
+      PCM_PEAK_LOOP(pcm_read_q31_int32, 4, level_meter_acc_q31);
+      break;
+    case VBAN_DATATYPE_FLOAT32:
+      PCM_PEAK_LOOP(pcm_read_float32, 4, level_meter_acc_float);
+      break;
+    case VBAN_DATATYPE_FLOAT64:
+      PCM_PEAK_LOOP(pcm_read_float64, 8, level_meter_acc_float);
+      break;
+    default:
+      return LEVEL_METER_FULL_SCALE;
+  }
+  return acc.peak;
+}
+
+#if CONFIG_VBAN_FIXED_FORMAT
+HOT_PATH_ATTR esp_err_t pcm_convert_from_fixed(void* dst, vban_data_type_t dst_type, const void* src, size_t num_samples,
+                                               level_meter_acc_t* meter) {
+  const vban_data_type_t src_type = (vban_data_type_t)CONFIG_VBAN_FIXED_DATA_TYPE;
+  if ((!dst || !src) && num_samples > 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (dst_type == src_type && !meter) {
+    memcpy(dst, src, num_samples * CONFIG_VBAN_FIXED_SAMPLE_BYTES);
+    return ESP_OK;
+  }
+  return pcm_convert_dispatch(dst, dst_type, src, src_type, num_samples, meter);
+}
+#endif
+
+// --- Gain ---
+
+HOT_PATH_ATTR void pcm_gain_float(float* samples, size_t num_samples, float gain, level_meter_acc_t* meter) {
+  if (!meter) {
+    for (size_t i = 0; i < num_samples; i++) {
+      samples[i] *= gain;
+    }
+    return;
+  }
+  level_meter_acc_t acc = {0};
+  for (size_t i = 0; i < num_samples; i++) {
+    const float v = samples[i] * gain;
+    samples[i] = v;
+    level_meter_acc_float(&acc, v);
+  }
+  level_meter_acc_merge(meter, &acc, num_samples);
+}
+
+// --- Crossfade ---
+
+void pcm_crossfade_init(pcm_crossfade_t* fade, size_t frames) {
+  const float step = frames > 0 ? (float)M_PI_2 / (float)frames : 0.0f;
+  fade->gain_out = frames > 0 ? 1.0f : 0.0f;
+  fade->gain_in = frames > 0 ? 0.0f : 1.0f;
+  fade->step_cos = cosf(step);
+  fade->step_sin = sinf(step);
+  fade->remaining = frames;
+}
+
+static inline float pcm_int16_to_float(int16_t v) { return (float)v * (1.0f / 32768.0f); }
+
+static inline float pcm_identity_float(float v) { return v; }
+
+// One loop per sample type; the fade part and the copy part are split so the inner loops stay branch-free.
+#define PCM_CROSSFADE_LOOP(ctype, to_float, from_float)                               \
+  do {                                                                                \
+    ctype* d = (ctype*)dst;                                                           \
+    const ctype* s = (const ctype*)fade_in;                                           \
+    size_t fade_frames = frames < fade->remaining ? frames : fade->remaining;         \
+    float g_out = fade->gain_out;                                                     \
+    float g_in = fade->gain_in;                                                       \
+    for (size_t f = 0; f < fade_frames; f++, d += num_channels, s += num_channels) {  \
+      for (size_t c = 0; c < num_channels; c++) {                                     \
+        d[c] = from_float(to_float(d[c]) * g_out + to_float(s[c]) * g_in);            \
+      }                                                                               \
+      const float next_out = g_out * fade->step_cos - g_in * fade->step_sin;          \
+      g_in = g_in * fade->step_cos + g_out * fade->step_sin;                          \
+      g_out = next_out;                                                               \
+    }                                                                                 \
+    fade->remaining -= fade_frames;                                                   \
+    if (fade->remaining == 0) { /* End exactly on (0, 1) despite rounding */          \
+      g_out = 0.0f;                                                                   \
+      g_in = 1.0f;                                                                    \
+    }                                                                                 \
+    fade->gain_out = g_out;                                                           \
+    fade->gain_in = g_in;                                                             \
+    memcpy(d, s, (frames - fade_frames) * num_channels * sizeof(ctype));              \
+  } while (0)
+
+HOT_PATH_ATTR esp_err_t pcm_crossfade(void* dst, const void* fade_in, vban_data_type_t type, size_t num_channels, size_t frames,
+                                      pcm_crossfade_t* fade) {
+  if (!fade || ((!dst || !fade_in) && frames > 0)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  switch (type) {
+    case VBAN_DATATYPE_INT16:
+      PCM_CROSSFADE_LOOP(int16_t, pcm_int16_to_float, pcm_float_to_int16);
+      return ESP_OK;
+    case VBAN_DATATYPE_INT32:
+      PCM_CROSSFADE_LOOP(int32_t, pcm_q31_to_float, pcm_float_to_q31);
+      return ESP_OK;
+    case VBAN_DATATYPE_FLOAT32:
+      PCM_CROSSFADE_LOOP(float, pcm_identity_float, pcm_identity_float);
+      return ESP_OK;
+    default:
+      return ESP_ERR_NOT_SUPPORTED;
+  }
+}
+
+// --- Gain ramp ---
+
+#define PCM_RAMP_LOOP(ctype, to_float, from_float)                      \
+  do {                                                                  \
+    ctype* d = (ctype*)samples;                                         \
+    float g = gain_from;                                                \
+    for (size_t f = 0; f < frames; f++, d += num_channels, g += step) { \
+      for (size_t c = 0; c < num_channels; c++) {                       \
+        d[c] = from_float(to_float(d[c]) * g);                          \
+      }                                                                 \
+    }                                                                   \
+  } while (0)
+
+HOT_PATH_ATTR esp_err_t pcm_ramp(void* samples, vban_data_type_t type, size_t num_channels, size_t frames, float gain_from, float gain_to) {
+  if (!samples && frames > 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  const float step = frames > 1 ? (gain_to - gain_from) / (float)(frames - 1) : 0.0f;
+  switch (type) {
+    case VBAN_DATATYPE_INT16:
+      PCM_RAMP_LOOP(int16_t, pcm_int16_to_float, pcm_float_to_int16);
+      return ESP_OK;
+    case VBAN_DATATYPE_INT32:
+      PCM_RAMP_LOOP(int32_t, pcm_q31_to_float, pcm_float_to_q31);
+      return ESP_OK;
+    case VBAN_DATATYPE_FLOAT32:
+      PCM_RAMP_LOOP(float, pcm_identity_float, pcm_identity_float);
+      return ESP_OK;
+    default:
+      return ESP_ERR_NOT_SUPPORTED;
+  }
+}
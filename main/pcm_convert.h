@@ -0,0 +1,187 @@
+#ifndef PCM_CONVERT_H_
+#define PCM_CONVERT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "level_meter.h"
+#include "sdkconfig.h"
+#include "vban.h"  // For vban_data_type_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PCM_CONVERT_ALIGNMENT 16  // Source buffers aligned to this take the aligned conversion kernels
+
+/**
+ * @brief Check whether a VBAN data type can be produced by pcm_convert().
+ *
+ * @param dst_type Destination data type.
+ * @return true for VBAN_DATATYPE_INT16, VBAN_DATATYPE_INT32 and VBAN_DATATYPE_FLOAT32.
+ */
+bool pcm_convert_is_output_supported(vban_data_type_t dst_type);
+
+/**
+ * @brief Convert interleaved PCM samples between VBAN data types.
+ *
+ * Integer sources are scaled to the destination full scale (e.g. INT16 0x4000 becomes INT32 0x40000000),
+ * float sources are clamped to [-1.0, 1.0). Identical source and destination types are copied as-is.
+ * The source buffer may be unaligned; a source aligned to PCM_CONVERT_ALIGNMENT (e.g. a received payload, see
+ * CONFIG_VBAN_PAYLOAD_ALIGNMENT) is converted by kernels compiled for aligned loads.
+ *
+ * @param dst Destination buffer (num_samples * vban_get_data_type_size(dst_type) bytes).
+ * @param dst_type Destination data type (see pcm_convert_is_output_supported()).
+ * @param src Source buffer.
+ * @param src_type Source data type (UINT8, INT16, INT24, INT32, FLOAT32 or FLOAT64).
+ * @param num_samples Number of samples (frames * channels) to convert.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL buffer
+ * - ESP_ERR_NOT_SUPPORTED: Unsupported source or destination type
+ */
+esp_err_t pcm_convert(void* dst, vban_data_type_t dst_type, const void* src, vban_data_type_t src_type, size_t num_samples);
+
+/**
+ * @brief pcm_convert() that also meters the samples (peak, RMS, clips) as they pass through the conversion loop.
+ *
+ * The levels are accumulated in registers and added to meter once per call, so metering costs a few instructions
+ * per sample and no extra pass or memory traffic. With a meter, identical source and destination types go through
+ * the identity kernel instead of memcpy() (still bit-exact).
+ *
+ * @param dst Destination buffer (num_samples * vban_get_data_type_size(dst_type) bytes).
+ * @param dst_type Destination data type (see pcm_convert_is_output_supported()).
+ * @param src Source buffer.
+ * @param src_type Source data type.
+ * @param num_samples Number of samples (frames * channels) to convert.
+ * @param meter Accumulator the levels of the source samples are added to (NULL for pcm_convert()).
+ * @return Same as pcm_convert().
+ */
+esp_err_t pcm_convert_metered(void* dst, vban_data_type_t dst_type, const void* src, vban_data_type_t src_type, size_t num_samples,
+                              level_meter_acc_t* meter);
+
+/**
+ * @brief Scale float samples in place, metering the scaled samples in the same loop.
+ *
+ * @param samples Samples to scale.
+ * @param num_samples Number of samples.
+ * @param gain Linear gain.
+ * @param meter Accumulator the levels of the scaled samples are added to (NULL to only scale).
+ */
+void pcm_gain_float(float* samples, size_t num_samples, float gain, level_meter_acc_t* meter);
+
+/**
+ * @brief Route interleaved channels into another interleaved layout, e.g. the slots of a TDM frame.
+ *
+ * Channel i of each destination frame takes source channel map[i], or silence for a negative entry, so a channel
+ * can feed several slots and slots can stay silent. Source and destination share the sample type: each destination
+ * sample is one load and one store, written straight into the slot layout.
+ *
+ * @param dst Destination buffer (frames * dst_channels samples).
+ * @param dst_channels Channels (slots) per destination frame.
+ * @param src Source buffer (frames * src_channels samples).
+ * @param src_channels Channels per source frame.
+ * @param map Source channel of each destination channel (dst_channels entries, negative for silence).
+ * @param type Sample type of both buffers (see pcm_convert_is_output_supported()).
+ * @param frames Number of frames.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer, or a map entry not below src_channels
+ * - ESP_ERR_NOT_SUPPORTED: Unsupported type
+ */
+esp_err_t pcm_route(void* dst, size_t dst_channels, const void* src, size_t src_channels, const int8_t* map, vban_data_type_t type,
+                    size_t frames);
+
+/**
+ * @brief Get the peak magnitude of interleaved PCM samples without converting them.
+ *
+ * A read-only scan (no stores) with the readers of pcm_convert(), e.g. to check whether a packet is silent before
+ * spending a conversion on it.
+ *
+ * @param src Source buffer.
+ * @param type Source data type (UINT8, INT16, INT24, INT32, FLOAT32 or FLOAT64).
+ * @param num_samples Number of samples (frames * channels).
+ * @return Peak magnitude on the 16-bit meter scale (0 to LEVEL_METER_FULL_SCALE). Unsupported types read as
+ *         LEVEL_METER_FULL_SCALE so that they are never taken for silence.
+ */
+uint32_t pcm_peak(const void* src, vban_data_type_t type, size_t num_samples);
+
+#if CONFIG_VBAN_FIXED_FORMAT
+/**
+ * @brief pcm_convert() from the build-time sample type (CONFIG_VBAN_FIXED_DATA_TYPE).
+ *
+ * The source type is a constant, so the conversion compiles to the loops of that type only.
+ *
+ * @param dst Destination buffer (num_samples * vban_get_data_type_size(dst_type) bytes).
+ * @param dst_type Destination data type (see pcm_convert_is_output_supported()).
+ * @param src Source buffer of CONFIG_VBAN_FIXED_DATA_TYPE samples.
+ * @param num_samples Number of samples (frames * channels) to convert.
+ * @param meter Accumulator of the levels (see pcm_convert_metered()), or NULL.
+ * @return Same as pcm_convert().
+ */
+esp_err_t pcm_convert_from_fixed(void* dst, vban_data_type_t dst_type, const void* src, size_t num_samples, level_meter_acc_t* meter);
+#endif
+
+/**
+ * @brief State of an equal-power crossfade (gains cos/sin of an angle going from 0 to pi/2).
+ */
+typedef struct {
+  float gain_out;    ///< Gain of the signal being faded out
+  float gain_in;     ///< Gain of the signal being faded in
+  float step_cos;    ///< Cosine of the per-frame rotation of (gain_out, gain_in)
+  float step_sin;    ///< Sine of the per-frame rotation of (gain_out, gain_in)
+  size_t remaining;  ///< Frames until the fade is complete
+} pcm_crossfade_t;
+
+/**
+ * @brief Start an equal-power crossfade.
+ *
+ * @param fade Crossfade state.
+ * @param frames Length of the fade in frames (0 for an immediate switch).
+ */
+void pcm_crossfade_init(pcm_crossfade_t* fade, size_t frames);
+
+/**
+ * @brief Crossfade interleaved PCM in place: dst = dst * gain_out + fade_in * gain_in, advancing the fade per frame.
+ *
+ * The gains follow cos/sin by rotating them frame by frame, so no trigonometry is evaluated per sample.
+ * Frames after the end of the fade are copied from fade_in.
+ *
+ * @param dst Signal being faded out, overwritten with the mix.
+ * @param fade_in Signal being faded in.
+ * @param type Sample type of both buffers (see pcm_convert_is_output_supported()).
+ * @param num_channels Number of interleaved channels.
+ * @param frames Number of frames.
+ * @param fade Crossfade state, advanced by frames.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer
+ * - ESP_ERR_NOT_SUPPORTED: Unsupported type
+ */
+esp_err_t pcm_crossfade(void* dst, const void* fade_in, vban_data_type_t type, size_t num_channels, size_t frames, pcm_crossfade_t* fade);
+
+/**
+ * @brief Apply a linear gain ramp to interleaved PCM in place (e.g. a fade to silence before muting).
+ *
+ * The first frame is scaled by gain_from and the last one by gain_to.
+ *
+ * @param samples Samples to scale.
+ * @param type Sample type (see pcm_convert_is_output_supported()).
+ * @param num_channels Number of interleaved channels.
+ * @param frames Number of frames.
+ * @param gain_from Gain of the first frame.
+ * @param gain_to Gain of the last frame.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer
+ * - ESP_ERR_NOT_SUPPORTED: Unsupported type
+ */
+esp_err_t pcm_ramp(void* samples, vban_data_type_t type, size_t num_channels, size_t frames, float gain_from, float gain_to);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PCM_CONVERT_H_
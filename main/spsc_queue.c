@@ -0,0 +1,47 @@
+#include "spsc_queue.h"
+
+#include <string.h>  // For memcpy
+
+#include "hot_path.h"
+
+esp_err_t spsc_queue_init(spsc_queue_t *q, void *storage, size_t item_size, size_t capacity) {
+  if (!q || !storage || item_size == 0 || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  q->items = (uint8_t *)storage;
+  q->item_size = item_size;
+  q->mask = capacity - 1;
+  atomic_init(&q->head, 0);
+  atomic_init(&q->tail, 0);
+  return ESP_OK;
+}
+
+HOT_PATH_ATTR bool spsc_queue_push(spsc_queue_t *q, const void *item) {
+  size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);  // Only this task writes head
+  size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);  // The consumer is done with the slot
+  if (head - tail > q->mask) {
+    return false;
+  }
+
+  memcpy(q->items + (head & q->mask) * q->item_size, item, q->item_size);
+  atomic_store_explicit(&q->head, head + 1, memory_order_release);  // Publishes the item
+  return true;
+}
+
+HOT_PATH_ATTR bool spsc_queue_pop(spsc_queue_t *q, void *item) {
+  size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);  // Only this task writes tail
+  size_t head = atomic_load_explicit(&q->head, memory_order_acquire);  // The item is visible
+  if (head == tail) {
+    return false;
+  }
+
+  memcpy(item, q->items + (tail & q->mask) * q->item_size, q->item_size);
+  atomic_store_explicit(&q->tail, tail + 1, memory_order_release);  // Hands the slot back to the producer
+  return true;
+}
+
+size_t spsc_queue_get_count(spsc_queue_t *q) {
+  size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+  return atomic_load_explicit(&q->head, memory_order_acquire) - tail;
+}
@@ -0,0 +1,74 @@
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Lock-free single-producer single-consumer queue of fixed-size items
+ *
+ * One task pushes and one task pops, possibly on different cores, without locks or critical sections:
+ * the producer only advances head and the consumer only advances tail. Items are copied in and out,
+ * so they should be small (e.g. descriptors pointing at buffers whose ownership moves with them).
+ */
+typedef struct {
+  uint8_t *items;      /**< capacity * item_size bytes */
+  size_t item_size;    /**< Size of one item in bytes */
+  size_t mask;         /**< capacity - 1 (the capacity is a power of two) */
+  atomic_size_t head;  /**< Items pushed so far (free-running), written by the producer */
+  atomic_size_t tail;  /**< Items popped so far (free-running), written by the consumer */
+} spsc_queue_t;
+
+/**
+ * @brief Initialize an empty queue on caller-supplied memory
+ *
+ * @param q Pointer to the queue structure
+ * @param storage Memory for the items (at least capacity * item_size bytes)
+ * @param item_size Size of one item in bytes
+ * @param capacity Number of items the queue holds (power of two)
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer, zero item size or capacity not a power of two
+ */
+esp_err_t spsc_queue_init(spsc_queue_t *q, void *storage, size_t item_size, size_t capacity);
+
+/**
+ * @brief Append an item (producer only)
+ *
+ * @param q Pointer to the queue structure
+ * @param item Item to copy into the queue
+ * @return true on success, false if the queue is full
+ */
+bool spsc_queue_push(spsc_queue_t *q, const void *item);
+
+/**
+ * @brief Remove the oldest item (consumer only)
+ *
+ * @param q Pointer to the queue structure
+ * @param[out] item Receives a copy of the item
+ * @return true on success, false if the queue is empty
+ */
+bool spsc_queue_pop(spsc_queue_t *q, void *item);
+
+/**
+ * @brief Get the number of queued items
+ * Exact for the producer and the consumer; other tasks get a snapshot.
+ *
+ * @param q Pointer to the queue structure
+ * @return Number of items in the queue
+ */
+size_t spsc_queue_get_count(spsc_queue_t *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SPSC_QUEUE_H_
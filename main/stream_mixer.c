@@ -0,0 +1,191 @@
+#include "stream_mixer.h"
+
+#include <string.h>  // For memset
+
+#include "esp_heap_caps.h"
+#include "hot_path.h"
+#include "pcm_convert.h"
+
+#define STREAM_MIXER_REDUCTION_JOBS 2  // Sample ranges of the reduction, one per core
+
+// Block buffers are aligned so that pcm_convert() takes its aligned kernels
+static void *stream_mixer_calloc(const stream_mixer_t *mixer, size_t n, size_t size) {
+  if (mixer->config.arena) {
+    return vban_arena_alloc(mixer->config.arena, n * size, PCM_CONVERT_ALIGNMENT);
+  }
+  return heap_caps_aligned_calloc(PCM_CONVERT_ALIGNMENT, n, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+// Memory from the arena is released with the arena
+static void stream_mixer_free(const stream_mixer_t *mixer, void *ptr) {
+  if (!mixer->config.arena) {
+    heap_caps_free(ptr);
+  }
+}
+
+esp_err_t stream_mixer_init(stream_mixer_t *mixer, const stream_mixer_config_t *config) {
+  if (!mixer || !config || !pcm_convert_is_output_supported(config->data_type) || config->num_channels == 0 ||
+      config->block_frames == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  memset(mixer, 0, sizeof(*mixer));
+  mixer->config = *config;
+  mixer->sum = (float *)stream_mixer_calloc(mixer, config->block_frames * config->num_channels, sizeof(float));
+  if (!mixer->sum) {
+    return ESP_ERR_NO_MEM;
+  }
+  StackType_t *stack = NULL;  // Allocated by fork_join_init() without an arena
+  if (config->arena) {
+    stack = (StackType_t *)vban_arena_alloc(config->arena, config->worker_stack_size, 0);
+    if (!stack) {
+      return ESP_ERR_NO_MEM;
+    }
+  }
+  esp_err_t ret = fork_join_init(&mixer->fork_join, config->worker_core_id, config->worker_priority, config->worker_stack_size, stack);
+  if (ret != ESP_OK) {
+    stream_mixer_free(mixer, mixer->sum);
+    mixer->sum = NULL;
+  }
+  return ret;
+}
+
+void stream_mixer_deinit(stream_mixer_t *mixer) {
+  if (!mixer) {
+    return;
+  }
+
+  fork_join_deinit(&mixer->fork_join);
+  for (size_t i = 0; i < mixer->num_streams; i++) {
+    stream_mixer_free(mixer, mixer->streams[i].pulled);
+    stream_mixer_free(mixer, mixer->streams[i].scaled);
+  }
+  stream_mixer_free(mixer, mixer->sum);
+  memset(mixer, 0, sizeof(*mixer));
+}
+
+esp_err_t stream_mixer_add_stream(stream_mixer_t *mixer, vban_handle_t receiver, float gain) {
+  if (!mixer || !receiver) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  vban_audio_format_t format;
+  esp_err_t ret = vban_receiver_get_pull_format(receiver, &format);
+  if (ret != ESP_OK) {
+    return ret == ESP_ERR_VBAN_INVALID_STATE ? ESP_ERR_INVALID_STATE : ESP_ERR_INVALID_ARG;
+  }
+  if (format.num_channels != mixer->config.num_channels) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (mixer->num_streams >= STREAM_MIXER_MAX_STREAMS) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  const size_t samples = mixer->config.block_frames * mixer->config.num_channels;
+  stream_mixer_stream_t *stream = &mixer->streams[mixer->num_streams];
+  stream->scaled = (float *)stream_mixer_calloc(mixer, samples, sizeof(float));
+  if (format.data_type != VBAN_DATATYPE_FLOAT32) {  // Float streams are pulled straight into scaled
+    stream->pulled = stream_mixer_calloc(mixer, samples, vban_get_data_type_size(format.data_type));
+  }
+  if (!stream->scaled || (format.data_type != VBAN_DATATYPE_FLOAT32 && !stream->pulled)) {
+    stream_mixer_free(mixer, stream->scaled);
+    stream_mixer_free(mixer, stream->pulled);
+    memset(stream, 0, sizeof(*stream));
+    return ESP_ERR_NO_MEM;
+  }
+  stream->receiver = receiver;
+  stream->type = format.data_type;
+  stream->gain = gain;
+  level_meter_init(&stream->meter, vban_get_sr_from_index(format.sample_rate_idx) / 1000 * VBAN_LEVEL_WINDOW_MS * format.num_channels);
+  mixer->num_streams++;
+  return ESP_OK;
+}
+
+esp_err_t stream_mixer_set_gain(stream_mixer_t *mixer, size_t index, float gain) {
+  if (!mixer || index >= mixer->num_streams) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  mixer->streams[index].gain = gain;
+  return ESP_OK;
+}
+
+esp_err_t stream_mixer_get_levels(stream_mixer_t *mixer, size_t index, level_meter_levels_t *levels) {
+  if (!mixer || !levels || index >= mixer->num_streams) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  level_meter_read(&mixer->streams[index].meter, levels);
+  return ESP_OK;
+}
+
+esp_err_t stream_mixer_set_eq(stream_mixer_t *mixer, size_t index, biquad_eq_t *eq) {
+  if (!mixer || index >= mixer->num_streams || (eq && eq->num_channels != mixer->config.num_channels)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  mixer->streams[index].eq = eq;
+  return ESP_OK;
+}
+
+// Per-stream job: pull, convert to float, apply the gain and meter in one loop, then the equalizer
+static HOT_PATH_ATTR void stream_mixer_process_stream(void *ctx, size_t index) {
+  stream_mixer_t *mixer = (stream_mixer_t *)ctx;
+  stream_mixer_stream_t *stream = &mixer->streams[index];
+  const size_t block_frames = mixer->config.block_frames;
+  const size_t samples = block_frames * mixer->config.num_channels;
+
+  void *pulled = stream->pulled ? stream->pulled : stream->scaled;
+  size_t frames = 0;
+  vban_receiver_read(stream->receiver, pulled, block_frames, 0, &frames);
+  if (frames < block_frames) {
+    const size_t frame_bytes = mixer->config.num_channels * vban_get_data_type_size(stream->type);
+    memset((uint8_t *)pulled + frames * frame_bytes, 0, (block_frames - frames) * frame_bytes);  // Zero is silence in every type
+    stream->underruns++;
+  }
+  if (stream->pulled) {
+    pcm_convert(stream->scaled, VBAN_DATATYPE_FLOAT32, stream->pulled, stream->type, samples);
+  }
+
+  level_meter_acc_t levels = {0};
+  pcm_gain_float(stream->scaled, samples, stream->gain, &levels);
+  level_meter_add(&stream->meter, &levels);
+  if (stream->eq) {
+    biquad_eq_process(stream->eq, stream->scaled, block_frames);
+  }
+}
+
+// Reduction job: sum a range of samples over every stream, always in stream order, and convert it to the output
+static HOT_PATH_ATTR void stream_mixer_reduce(void *ctx, size_t index) {
+  stream_mixer_t *mixer = (stream_mixer_t *)ctx;
+  const size_t samples = mixer->config.block_frames * mixer->config.num_channels;
+  const size_t channels = mixer->config.num_channels;
+  // Split on frame boundaries so the ranges are whole frames
+  const size_t frames_per_job = (mixer->config.block_frames + STREAM_MIXER_REDUCTION_JOBS - 1) / STREAM_MIXER_REDUCTION_JOBS;
+  const size_t begin = index * frames_per_job * channels;
+  const size_t end = begin + frames_per_job * channels < samples ? begin + frames_per_job * channels : samples;
+  if (begin >= end) {
+    return;
+  }
+
+  float *sum = mixer->sum;
+  memset(sum + begin, 0, (end - begin) * sizeof(float));
+  for (size_t s = 0; s < mixer->num_streams; s++) {
+    const float *scaled = mixer->streams[s].scaled;
+    for (size_t i = begin; i < end; i++) {
+      sum[i] += scaled[i];
+    }
+  }
+  const size_t sample_bytes = vban_get_data_type_size(mixer->config.data_type);
+  pcm_convert((uint8_t *)mixer->dst + begin * sample_bytes, mixer->config.data_type, sum + begin, VBAN_DATATYPE_FLOAT32, end - begin);
+}
+
+HOT_PATH_ATTR esp_err_t stream_mixer_mix(stream_mixer_t *mixer, void *dst) {
+  if (!mixer || !dst) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  mixer->dst = dst;
+  fork_join_run(&mixer->fork_join, stream_mixer_process_stream, mixer, mixer->num_streams);  // Fork per stream
+  fork_join_run(&mixer->fork_join, stream_mixer_reduce, mixer, STREAM_MIXER_REDUCTION_JOBS);  // Join: deterministic sum
+  return ESP_OK;
+}
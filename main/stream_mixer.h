@@ -0,0 +1,153 @@
+#ifndef STREAM_MIXER_H_
+#define STREAM_MIXER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "biquad_eq.h"
+#include "esp_err.h"
+#include "fork_join.h"
+#include "level_meter.h"
+#include "vban.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STREAM_MIXER_MAX_STREAMS 8  // Max streams mixed into one output
+
+/**
+ * @brief Mixer configuration
+ */
+typedef struct {
+  vban_data_type_t data_type;   /**< Output sample type (see pcm_convert_is_output_supported()) */
+  uint8_t num_channels;         /**< Channels of the output and of every stream */
+  size_t block_frames;          /**< Frames per mixed block */
+  int worker_core_id;           /**< Core of the fork-join worker; call stream_mixer_mix() from the other one */
+  UBaseType_t worker_priority;  /**< Priority of the worker (usually that of the mixing task) */
+  size_t worker_stack_size;     /**< Stack of the worker in bytes */
+  vban_arena_handle_t arena;    /**< Arena for the buffers and the worker's stack (NULL for the heap) */
+} stream_mixer_config_t;
+
+/**
+ * @brief One input of the mixer
+ */
+typedef struct {
+  vban_handle_t receiver;       /**< Receiver created with pull_enabled */
+  vban_data_type_t type;        /**< Sample type of the receiver's pull format */
+  volatile float gain;          /**< Linear gain, may be changed while mixing */
+  void *pulled;                 /**< block_frames frames as pulled (unused for FLOAT32 streams) */
+  float *scaled;                /**< block_frames frames converted to float and scaled by gain */
+  volatile uint32_t underruns;  /**< Blocks padded with silence because the stream had too few frames */
+  level_meter_t meter;          /**< Levels after the gain, measured by the gain loop (see stream_mixer_get_levels()) */
+  biquad_eq_t *eq;              /**< Equalizer run after the gain (NULL for none, see stream_mixer_set_eq()) */
+} stream_mixer_stream_t;
+
+/**
+ * @brief Mixer of the pull outputs of several receivers
+ *
+ * Each block is produced in two fork-join runs over both cores: first one job per stream pulls block_frames
+ * frames from its receiver (padding with silence on underrun), converts them to float and applies the gain
+ * (metering the result in the same loop); then the reduction sums the streams in index order, split by sample
+ * range between the cores, and converts the sum to the output type with clamping. Every sample is summed in the
+ * same order whichever core did the work, so the output is bit-exact from run to run. All memory is allocated by
+ * stream_mixer_init() and stream_mixer_add_stream(), from the configured arena when there is one (it is then
+ * released with the arena, which must outlive the mixer).
+ */
+typedef struct {
+  stream_mixer_config_t config;                             /**< Configuration */
+  stream_mixer_stream_t streams[STREAM_MIXER_MAX_STREAMS];  /**< Inputs, in mixing order */
+  size_t num_streams;                                       /**< Number of inputs */
+  float *sum;                                               /**< Reduction of the inputs of the current block */
+  void *dst;                                                /**< Output of the current block */
+  fork_join_t fork_join;                                    /**< Scheduler of the per-stream and reduction jobs */
+} stream_mixer_t;
+
+/**
+ * @brief Initialize a mixer without inputs and start its worker
+ *
+ * @param mixer Pointer to the mixer structure
+ * @param config Configuration
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer, unsupported output type, zero channels or zero block size
+ * - ESP_ERR_NO_MEM: Out of memory
+ */
+esp_err_t stream_mixer_init(stream_mixer_t *mixer, const stream_mixer_config_t *config);
+
+/**
+ * @brief Stop the worker and release the mixer
+ *
+ * @param mixer Pointer to the mixer structure
+ */
+void stream_mixer_deinit(stream_mixer_t *mixer);
+
+/**
+ * @brief Add a receiver as an input (at setup time, not while mixing)
+ *
+ * @param mixer Pointer to the mixer structure
+ * @param receiver Receiver created with pull_enabled, whose pull format has the mixer's channel count
+ * @param gain Linear gain of the input
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer, or the receiver's pull format does not match
+ * - ESP_ERR_INVALID_STATE: The receiver was not created with pull_enabled
+ * - ESP_ERR_NO_MEM: STREAM_MIXER_MAX_STREAMS inputs already, or out of memory
+ */
+esp_err_t stream_mixer_add_stream(stream_mixer_t *mixer, vban_handle_t receiver, float gain);
+
+/**
+ * @brief Change the gain of an input (from any task)
+ *
+ * @param mixer Pointer to the mixer structure
+ * @param index Index of the input (order of stream_mixer_add_stream() calls)
+ * @param gain Linear gain, applied from the next block
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL mixer or unknown index
+ */
+esp_err_t stream_mixer_set_gain(stream_mixer_t *mixer, size_t index, float gain);
+
+/**
+ * @brief Get the levels of an input after its gain (from any task, lock-free)
+ * Peak and RMS cover the last VBAN_LEVEL_WINDOW_MS window (see vban_receiver_get_levels() for the scale).
+ *
+ * @param mixer Pointer to the mixer structure
+ * @param index Index of the input (order of stream_mixer_add_stream() calls)
+ * @param[out] levels Receives the levels
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer or unknown index
+ */
+esp_err_t stream_mixer_get_levels(stream_mixer_t *mixer, size_t index, level_meter_levels_t *levels);
+
+/**
+ * @brief Run an equalizer on an input after its gain (at setup time, not while mixing)
+ * The equalizer's coefficients can then be changed at any time with biquad_eq_set_sections().
+ *
+ * @param mixer Pointer to the mixer structure
+ * @param index Index of the input (order of stream_mixer_add_stream() calls)
+ * @param eq Equalizer with the mixer's channel count (NULL to remove it)
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL mixer, unknown index or channel count mismatch
+ */
+esp_err_t stream_mixer_set_eq(stream_mixer_t *mixer, size_t index, biquad_eq_t *eq);
+
+/**
+ * @brief Mix one block
+ * Inputs with too few frames are padded with silence and do not block.
+ *
+ * @param mixer Pointer to the mixer structure
+ * @param dst Output (block_frames frames in the output format)
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_INVALID_ARG: NULL pointer
+ */
+esp_err_t stream_mixer_mix(stream_mixer_t *mixer, void *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // STREAM_MIXER_H_
@@ -1,12 +1,26 @@
 #include "vban.h"
 
+#include <stdatomic.h>
 #include <string.h>  // For memcpy, strlen, strncmp
 
+#include "alloc_guard.h"
+#include "arena.h"
+#include "circular_buffer.h"
+#include "dma_copy.h"
+#include "esp_cache.h"  // For esp_cache_get_alignment
+#include "esp_cpu.h"    // For esp_cpu_get_cycle_count
+#include "esp_heap_caps.h"  // For heap_caps_malloc
 #include "esp_log.h"
+#include "esp_timer.h"  // For esp_timer_get_time
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
+#include "hot_path.h"
 #include "lwip/netdb.h"    // For gethostbyname (not used here for simplicity, direct IP)
 #include "lwip/sockets.h"  // For socket functions
+#include "packet_pool.h"
+#include "pcm_convert.h"
+#include "spsc_queue.h"
 
 static const char* TAG = "vban";
 
@@ -22,23 +36,238 @@ typedef enum { VBAN_INSTANCE_TYPE_SENDER, VBAN_INSTANCE_TYPE_RECEIVER } vban_ins
 
 typedef enum { VBAN_RECEIVER_STATE_IDLE, VBAN_RECEIVER_STATE_RUNNING, VBAN_RECEIVER_STATE_STOPPING } vban_receiver_state_t;
 
+#define VBAN_REACTOR_POLL_INTERVAL_MS 100  // select() timeout, bounds how late the reactor notices a stop request
+#define VBAN_RECEIVE_TIMEOUT_MS 100        // Receive timeout of a receiver's socket, bounds how late its task notices a stop
+#define VBAN_TASK_REAP_POLL_MS 10          // Poll interval while waiting for an exiting task to park itself
+#define VBAN_TASK_REAP_TIMEOUT_MS 2000     // Longest wait for a task told to exit to park itself
+#define VBAN_DMA_MIN_ALIGNMENT 4           // Alignment of DMA buffers on targets whose internal RAM is not cached
+
+// Header bytes 4-7 (SR/sub-protocol, samples per frame, channels, format/codec) read as one little-endian word.
+// The reserved bit of the format byte is ignored, as in the full parse.
+#define VBAN_FORMAT_WORD_MASK (~((uint32_t)VBAN_RESERVED_BIT_MASK << 24))
+// Format word bits that decide whether a packet is already in pull_format (the frame count per packet may vary)
+#define VBAN_PASSTHROUGH_WORD_MASK (VBAN_FORMAT_WORD_MASK & ~((uint32_t)0xFF << 8))
+// Format word bits the pull ring requires of every packet: sample rate index and channels
+#define VBAN_PULL_WORD_MASK ((uint32_t)VBAN_SR_INDEX_MASK | ((uint32_t)0xFF << 16))
+
+#if CONFIG_VBAN_FIXED_FORMAT
+// Build-time stream (see vban_fast_match()): its format word (VBAN_PASSTHROUGH_WORD_MASK bits) and frame size
+#define VBAN_FIXED_FORMAT_WORD                                                                                            \
+  ((uint32_t)(CONFIG_VBAN_FIXED_SR_INDEX | VBAN_SUBPROTOCOL_AUDIO) | ((uint32_t)(CONFIG_VBAN_FIXED_CHANNELS - 1) << 16) | \
+   ((uint32_t)(CONFIG_VBAN_FIXED_DATA_TYPE | VBAN_CODEC_PCM) << 24))
+#define VBAN_FIXED_FRAME_BYTES (CONFIG_VBAN_FIXED_CHANNELS * CONFIG_VBAN_FIXED_SAMPLE_BYTES)
+
+static const char s_fixed_stream_name[VBAN_STREAM_NAME_MAX_LEN] = CONFIG_VBAN_FIXED_STREAM_NAME;  // Zero-padded
+#endif
+
+// Packet buffers hold any datagram we accept, FEC parity packets included
+#define VBAN_PACKET_BUFFER_SIZE VBAN_FEC_MAX_PACKET_SIZE
+// Packet buffers start this far past a CONFIG_VBAN_PAYLOAD_ALIGNMENT boundary, so that the payload after the 28-byte
+// header is aligned (4 bytes for 16-byte alignment, 36 for 64) and sample loops need no unaligned handling
+#define VBAN_PAYLOAD_ALIGNMENT CONFIG_VBAN_PAYLOAD_ALIGNMENT
+#define VBAN_PACKET_BUFFER_OFFSET ((VBAN_PAYLOAD_ALIGNMENT - VBAN_HEADER_SIZE % VBAN_PAYLOAD_ALIGNMENT) % VBAN_PAYLOAD_ALIGNMENT)
+
+// Packet buffers shared by all instances created without an arena (receive slots, held FEC groups, sender packets).
+// Instances reserve what they may hold at most when they are created or started, so the pool only grows at
+// setup time. Ownership of a received packet moves between slots and stages by pointer, without copying.
+static packet_pool_t s_packet_pool;
+static bool s_packet_pool_initialized = false;
+
+// Memory a pipeline's instances are carved from (see vban_arena_create()); the structure itself is its first object
+struct vban_arena_s {
+  arena_t arena;
+  packet_pool_t pool;  // Packet buffers of the instances created from the arena, with chunks carved from it
+  size_t num_users;    // Instances created from the arena and not deleted yet
+};
+
+// Receiver-side FEC state of the group currently being collected
+typedef struct {
+  char stream_name[VBAN_STREAM_NAME_MAX_LEN];        // Parity stream name, zero padded
+  uint32_t base;                                     // frame_counter of the first packet of the current (or last) group
+  bool started;                                      // base is valid
+  bool open;                                         // Group base is still being collected (otherwise it was delivered)
+  uint32_t held_mask;                                // Bit i set: held[i] holds packet base + i
+  vban_packet_desc_t held[VBAN_FEC_MAX_GROUP_SIZE];  // Held packets, their buffers are owned by the group
+  vban_packet_desc_t parity;                         // Parity packet of the group (header is NULL until received)
+  vban_packet_desc_t ordered[VBAN_FEC_MAX_GROUP_SIZE];  // Scratch for delivering a group in order (kept off the task stack)
+} vban_fec_rx_t;
+
+#define VBAN_FAILOVER_HISTORY 16           // Payload hashes per stream kept to align the two streams by content
+#define VBAN_FAILOVER_RESYNC_DISTANCE 256  // Frame distance treated as a sender restart rather than late or lost packets
+#define VBAN_FAILOVER_REVERT_PACKETS 64    // In-sequence primary packets required before switching back from the backup
+
+// Receiver-side state of a primary/backup stream pair. The active stream is played; packets of the standby stream
+// are held briefly to fill losses of the active stream and to switch over without a gap.
+typedef struct {
+  char backup_name[VBAN_STREAM_NAME_MAX_LEN];  // Zero padded
+  bool backup_active;                          // The backup stream is being played
+  bool synced;                                 // next is valid
+  uint32_t next;                               // Next frame to play, in the active stream's frame_counter
+  int64_t last_active_us;                      // Arrival time of the last packet played from the active stream
+  bool offset_valid;                           // offset is known
+  uint32_t offset;                             // Backup frame_counter minus primary frame_counter of the same audio
+  struct {
+    uint32_t frame_counter;
+    uint32_t hash;
+  } history[2][VBAN_FAILOVER_HISTORY];  // [0] primary, [1] backup; only filled while the offset is unknown
+  size_t history_pos[2];
+  vban_packet_desc_t hold[VBAN_FAILOVER_HOLD_PACKETS];  // Standby packets (header NULL if empty), buffers owned here
+  uint32_t standby_last;                                // Last standby frame_counter, for the revert streak
+  uint32_t standby_streak;                              // Consecutive in-sequence standby packets
+  vban_failover_event_t events[VBAN_FAILOVER_EVENT_LOG_SIZE];
+  uint32_t num_events;  // Total events recorded (the log keeps the last VBAN_FAILOVER_EVENT_LOG_SIZE)
+} vban_failover_rx_t;
+
+// Receiver-side state of a stream switch (see vban_receiver_select_stream())
+typedef struct {
+  portMUX_TYPE request_lock;  // Protects the request fields
+  volatile bool request_pending;
+  char request_name[VBAN_STREAM_NAME_MAX_LEN];
+  uint32_t request_ms;
+  // Owned by the receiving task
+  bool active;                              // A crossfade is in progress
+  char old_name[VBAN_STREAM_NAME_MAX_LEN];  // Stream faded out by the last switch (config.expected_stream_name is the new one);
+                                            // read by the receiving task only, stage 2 gets a flag per packet
+  circular_buffer_t stage_old;              // Converted frames of each stream waiting to be mixed
+  circular_buffer_t stage_new;
+  pcm_crossfade_t fade;
+} vban_crossfade_rx_t;
+
+// Stream discovery table (see vban_receiver_get_streams())
+#define VBAN_DISCOVERY_MAX_GAP 1000  // Larger frame_counter jumps are restarts or reordering, not losses
+#define VBAN_DISCOVERY_INTERVAL_SHIFT 3  // Weight 1/8 of the newest interval in the average
+
+typedef struct {
+  vban_stream_info_t info;  // Published part
+  bool used;
+  uint32_t last_frame;   // frame_counter of the last packet
+  uint32_t interval_us;  // Moving average of the time between packets
+} vban_discovery_entry_t;
+
+typedef struct {
+  portMUX_TYPE lock;  // Protects entries against vban_receiver_get_streams()
+  vban_discovery_entry_t entries[VBAN_DISCOVERY_MAX_STREAMS];
+  size_t last_hit;    // Entry of the previous packet, tried first: consecutive packets mostly share a stream
+  size_t age_cursor;  // Entry checked for expiry by the next packet, so aging costs one check per packet
+} vban_discovery_rx_t;
+
+// Silence gate of the pull path (see vban_receiver_config_t.silence_gate_ms)
+typedef struct {
+  uint32_t hold_frames;    // Silent frames before the gate goes idle
+  uint32_t silent_frames;  // Consecutive silent frames so far
+  uint16_t close_level;    // Peak up to which a packet is silent
+  uint16_t open_level;     // Peak above which an idle gate re-opens (hysteresis)
+  volatile bool idle;      // Silent packets are dropped before conversion
+} vban_gate_rx_t;
+
+// Counters of the delivery side (pull ring, silence gate), written by the delivering task: stage 2 on a staged
+// receiver, the receiving task otherwise. Kept apart from the receiving task's vban_receiver_stats_t so that every
+// block has a single writer; vban_receiver_get_stats() merges them.
+typedef struct {
+  uint32_t pull_overruns;  // Also counted by a crossfade the receiving task ends, under pull_mutex like all ring writes
+  vban_pull_path_t pull_path;
+  uint32_t passthrough_packets;
+  uint32_t gate_idle_packets;
+  uint32_t gate_closes;
+  uint64_t cycles;      // stage2_cycles
+  uint32_t cycles_max;  // stage2_cycles_max
+  atomic_uint seq;      // Sequence counter of cycles (see vban_stats_add_cycles())
+} vban_deliver_stats_t;
+
+// Packet queued to stage 2, with the stream it belongs to as decided by stage 1 (see vban_crossfade_is_old())
+typedef struct {
+  vban_packet_desc_t desc;
+  bool old_stream;  // Of the stream faded out by the last switch
+} vban_stage_packet_t;
+
+// Queue and task of the second stage of a staged receiver (see vban_receiver_config_t.staged)
+typedef struct {
+  spsc_queue_t queue;              // Accepted packets (vban_stage_packet_t), whose buffers (from the pool) are owned by the queue
+  SemaphoreHandle_t ready;         // Given by stage 1 after queueing a batch, and to stop stage 2
+  vban_packet_desc_t* batch;       // max_batch_packets descriptors popped by stage 2
+  bool* batch_old;                 // old_stream of each packet of batch
+  volatile bool running;           // Stage 2 is running: stage 1 queues instead of delivering
+  bool pushed;                     // Stage 1 queued packets in the current batch
+  TaskHandle_t task;               // Task of the last start until reaped
+  StaticTask_t task_tcb;
+  StackType_t* task_stack;         // Same size as the receive task's, set up by the first start
+  bool task_stack_owned;
+} vban_stage_rx_t;
+
 struct vban_instance_s {
   vban_instance_type_t type;
   int sock_fd;
+  size_t pool_reserved;       // Packet pool buffers reserved by this instance
+  vban_arena_handle_t arena;  // Arena the instance is carved from (NULL: heap)
+  packet_pool_t* pool;        // Pool of the instance's packet buffers (the arena's or the shared one)
   union {
     struct {
       vban_sender_config_t config;
       uint32_t frame_counter;
       struct sockaddr_in dest_addr;
+      uint8_t* tx_buffer;                              // Packet buffer from the pool
+      uint8_t* fec_parity;                             // Parity packet under construction (NULL without FEC)
+      size_t fec_parity_len;                           // Longest payload XORed into the current parity
+      char fec_stream_name[VBAN_STREAM_NAME_MAX_LEN];  // Parity stream name, zero padded
     } sender;
     struct {
       vban_receiver_config_t config;
       TaskHandle_t receive_task_handle;
+      TaskHandle_t task;        // Task of the last start until reaped (it parks itself after clearing receive_task_handle)
+      StaticTask_t task_tcb;    // Control block of the task
+      StackType_t* task_stack;  // Stack of the task (task_stack_size bytes), set up by the first start
+      size_t task_stack_size;
+      bool task_stack_owned;    // task_stack was allocated from the heap by the receiver
       volatile vban_receiver_state_t state;
+      size_t max_batch_packets;           // Number of packet slots (and descriptors) per batch
+      uint8_t** rx_slots;                 // max_batch_packets receive buffers from the packet pool
+      vban_packet_desc_t* batch_packets;  // Descriptors of the packets accepted in the current batch
+      struct vban_reactor_s* reactor;     // Reactor serving this receiver (NULL when it runs its own task)
+      // Pull interface (only used when config.pull_enabled)
+      circular_buffer_t pull_ring;        // Converted PCM frames, written by the receive task (DMA-capable)
+      void* pull_ring_storage;            // Storage of pull_ring (see vban_dma_ring_init())
+      size_t pull_frame_bytes;            // Size of one frame in pull_format
+      uint32_t passthrough_word;          // Format word (VBAN_PASSTHROUGH_WORD_MASK bits) of packets already in pull_format
+      SemaphoreHandle_t pull_mutex;       // Protects pull_ring
+      SemaphoreHandle_t pull_data_ready;  // Given by the receive task after new frames were committed
+      // Fast-path classification: format word and payload size of the last fully validated packet
+      uint32_t fast_format_word;
+      size_t fast_payload_size;  // SIZE_MAX (matches no packet) until a packet has been learned
+      bool follows_fixed;        // expected_stream_name is CONFIG_VBAN_FIXED_STREAM_NAME (CONFIG_VBAN_FIXED_FORMAT only)
+      vban_fec_rx_t fec;            // Only used when config.fec_group_size > 0
+      vban_failover_rx_t failover;  // Only used when config.backup_stream_name is set
+      vban_crossfade_rx_t crossfade;
+      vban_stage_rx_t stage;          // Only used when config.staged
+      vban_discovery_rx_t discovery;  // Only used when config.discovery_enabled
+      level_meter_t meter;            // Only used when config.metering_enabled
+      vban_gate_rx_t gate;            // Only used when config.silence_gate_ms > 0
+      vban_receiver_stats_t stats;          // Written by the receiving task only
+      atomic_uint stats_seq;                // Sequence counter of stats.process_cycles (see vban_stats_add_cycles())
+      vban_deliver_stats_t deliver_stats;  // Written by the delivering task only
     } receiver;
   } ctx;
 };
 
+// Reactor: one task serving the sockets of several receivers
+struct vban_reactor_s {
+  vban_reactor_config_t config;
+  TaskHandle_t task_handle;
+  TaskHandle_t task;  // Task of the last start until reaped (see the receiver's)
+  StaticTask_t task_tcb;
+  StackType_t* task_stack;
+  size_t task_stack_size;
+  bool task_stack_owned;
+  volatile vban_receiver_state_t state;
+  SemaphoreHandle_t mutex;  // Protects receivers/num_receivers, held while a ready socket is processed
+  vban_handle_t receivers[VBAN_REACTOR_MAX_RECEIVERS];
+  size_t num_receivers;
+  size_t max_batch_packets;
+  uint8_t** rx_slots;  // Shared by all receivers: only one socket is drained at a time
+  vban_packet_desc_t* batch_packets;
+  vban_arena_handle_t arena;  // Arena the reactor is carved from (NULL: heap)
+  packet_pool_t* pool;        // Pool of rx_slots, shared with every receiver served
+};
+
 // --- Utility Function Implementations ---
 
 size_t vban_get_data_type_size(vban_data_type_t data_type) {
@@ -99,28 +328,287 @@ static void vban_util_parse_format_codec_byte(uint8_t byte_val, vban_data_type_t
   if (codec_id) *codec_id = (uint8_t)((byte_val & VBAN_CODEC_MASK) >> VBAN_CODEC_SHIFT);
 }
 
+// FEC groups are aligned on frame_counter multiples of the group size, which must divide the 2^32 counter range
+static inline bool vban_fec_group_size_valid(uint8_t group_size) {
+  return group_size >= 2 && group_size <= VBAN_FEC_MAX_GROUP_SIZE && (group_size & (group_size - 1u)) == 0;
+}
+
+void vban_fec_get_stream_name(const char* stream_name, char fec_stream_name[VBAN_STREAM_NAME_MAX_LEN]) {
+  const size_t suffix_len = sizeof(VBAN_FEC_STREAM_SUFFIX) - 1;
+  size_t name_len = strnlen(stream_name, VBAN_STREAM_NAME_MAX_LEN - 1 - suffix_len);
+  memset(fec_stream_name, 0, VBAN_STREAM_NAME_MAX_LEN);
+  memcpy(fec_stream_name, stream_name, name_len);
+  memcpy(fec_stream_name + name_len, VBAN_FEC_STREAM_SUFFIX, suffix_len);
+}
+
+// dst ^= src over len bytes, a word at a time (dst and src may be unaligned)
+static HOT_PATH_ATTR void vban_xor_bytes(uint8_t* dst, const uint8_t* src, size_t len) {
+  size_t i = 0;
+  for (; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t)) {
+    uint32_t a, b;
+    memcpy(&a, dst + i, sizeof(a));
+    memcpy(&b, src + i, sizeof(b));
+    a ^= b;
+    memcpy(dst + i, &a, sizeof(a));
+  }
+  for (; i < len; i++) {
+    dst[i] ^= src[i];
+  }
+}
+
+// --- Memory ---
+// Everything an instance owns comes from its arena when it has one, otherwise from the heap. Arena memory is
+// never freed individually, so a pipeline built on an arena does not touch the heap after setup.
+
+static void* vban_arena_chunk_alloc(void* ctx, size_t size) { return arena_alloc((arena_t*)ctx, size, PACKET_POOL_ALIGNMENT); }
+
+vban_arena_handle_t vban_arena_create(size_t size, void* memory) {
+  arena_t arena;
+  if (arena_init(&arena, memory, size) != ESP_OK) {
+    ESP_LOGE(TAG, "Arena create: No memory for %d bytes", (int)size);
+    return NULL;
+  }
+  vban_arena_handle_t handle = (vban_arena_handle_t)arena_alloc(&arena, sizeof(struct vban_arena_s), 0);
+  if (!handle) {
+    ESP_LOGE(TAG, "Arena create: %d bytes is too small", (int)size);
+    arena_deinit(&arena);
+    return NULL;
+  }
+  handle->arena = arena;  // Includes the handle itself as used memory
+  portMUX_INITIALIZE(&handle->arena.lock);
+  packet_pool_init(&handle->pool, VBAN_PACKET_BUFFER_SIZE);
+  packet_pool_set_placement(&handle->pool, VBAN_PAYLOAD_ALIGNMENT, VBAN_PACKET_BUFFER_OFFSET);
+  packet_pool_set_allocator(&handle->pool, vban_arena_chunk_alloc, NULL, &handle->arena);
+  return handle;
+}
+
+esp_err_t vban_arena_delete(vban_arena_handle_t arena) {
+  if (!arena) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (arena->num_users > 0) {
+    ESP_LOGE(TAG, "Arena delete: %d instances still use the arena", (int)arena->num_users);
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+
+  packet_pool_deinit(&arena->pool);
+  arena_t memory = arena->arena;  // The handle lives in the memory being released
+  arena_deinit(&memory);
+  return ESP_OK;
+}
+
+size_t vban_arena_get_used(vban_arena_handle_t arena) { return arena ? arena_get_used(&arena->arena) : 0; }
+
+void* vban_arena_alloc(vban_arena_handle_t arena, size_t size, size_t alignment) {
+  return arena ? arena_alloc(&arena->arena, size, alignment) : NULL;
+}
+
+// Zeroed memory for an instance
+static void* vban_mem_alloc(vban_arena_handle_t arena, size_t size) {
+  return arena ? arena_alloc(&arena->arena, size, 0) : calloc(1, size);
+}
+
+static void vban_mem_free(vban_arena_handle_t arena, void* ptr) {
+  if (!arena) {
+    free(ptr);  // Arena memory is released with the arena
+  }
+}
+
+static SemaphoreHandle_t vban_mutex_create(vban_arena_handle_t arena) {
+  if (!arena) {
+    return xSemaphoreCreateMutex();
+  }
+  StaticSemaphore_t* storage = (StaticSemaphore_t*)vban_mem_alloc(arena, sizeof(StaticSemaphore_t));
+  return storage ? xSemaphoreCreateMutexStatic(storage) : NULL;
+}
+
+static SemaphoreHandle_t vban_binary_semaphore_create(vban_arena_handle_t arena) {
+  if (!arena) {
+    return xSemaphoreCreateBinary();
+  }
+  StaticSemaphore_t* storage = (StaticSemaphore_t*)vban_mem_alloc(arena, sizeof(StaticSemaphore_t));
+  return storage ? xSemaphoreCreateBinaryStatic(storage) : NULL;
+}
+
+static bool vban_ring_init(vban_arena_handle_t arena, circular_buffer_t* ring, size_t capacity) {
+  if (!arena) {
+    return circular_buffer_init(ring, capacity) == CB_SUCCESS;
+  }
+  void* storage = vban_mem_alloc(arena, capacity * 2);  // Mirrored, as circular_buffer_init() allocates it
+  return storage && circular_buffer_init_with_storage(ring, storage, capacity) == CB_SUCCESS;
+}
+
+// Ring the async memcpy DMA can copy out of (see dma_copy() in vban_receiver_read()): DMA-capable storage in whole
+// cache lines, so no other data shares a line with it. Writes happen under pull_mutex and stay on the CPU, so that
+// a reader never waits for a DMA copy to get the lock. It is the only DMA-capable memory of a pipeline, so it is taken from the DMA
+// heap at creation time even for receivers with an arena (whose block stays in ordinary internal RAM).
+static bool vban_dma_ring_init(circular_buffer_t* ring, size_t capacity, void** storage) {
+  size_t alignment = 0;
+  if (esp_cache_get_alignment(MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL, &alignment) != ESP_OK || alignment < VBAN_DMA_MIN_ALIGNMENT) {
+    alignment = VBAN_DMA_MIN_ALIGNMENT;
+  }
+  size_t size = (capacity * 2 + alignment - 1) & ~(alignment - 1);  // Mirrored, as circular_buffer_init() allocates it
+  *storage = heap_caps_aligned_calloc(alignment, 1, size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!*storage || circular_buffer_init_with_storage(ring, *storage, capacity) != CB_SUCCESS) {
+    return false;
+  }
+  return true;
+}
+
+// Pool of the packet buffers of instances created with the given arena. Instances are created from application
+// context, so the lazy initialization of the shared pool does not race.
+static packet_pool_t* vban_pool_get(vban_arena_handle_t arena) {
+  if (arena) {
+    return &arena->pool;
+  }
+  if (!s_packet_pool_initialized) {
+    packet_pool_init(&s_packet_pool, VBAN_PACKET_BUFFER_SIZE);
+    packet_pool_set_placement(&s_packet_pool, VBAN_PAYLOAD_ALIGNMENT, VBAN_PACKET_BUFFER_OFFSET);
+    s_packet_pool_initialized = true;
+  }
+  return &s_packet_pool;
+}
+
+// Attach a new handle to its arena and packet pool
+static void vban_handle_init(vban_handle_t handle, vban_arena_handle_t arena) {
+  handle->arena = arena;
+  handle->pool = vban_pool_get(arena);
+  if (arena) {
+    arena->num_users++;
+  }
+}
+
+// Release the handle itself, the last step of deleting an instance
+static void vban_handle_free(vban_handle_t handle) {
+  vban_arena_handle_t arena = handle->arena;
+  vban_mem_free(arena, handle);
+  if (arena) {
+    arena->num_users--;
+  }
+}
+
+// Reserve pool buffers for an instance
+static esp_err_t vban_pool_reserve(vban_handle_t handle, size_t count) {
+  esp_err_t err = packet_pool_reserve(handle->pool, count);
+  if (err == ESP_OK) {
+    handle->pool_reserved += count;
+  }
+  return err;
+}
+
+// Take count receive slots from the pool (a reservation must cover them)
+static uint8_t** vban_slots_alloc(vban_arena_handle_t arena, packet_pool_t* pool, size_t count) {
+  uint8_t** slots = (uint8_t**)vban_mem_alloc(arena, count * sizeof(uint8_t*));
+  if (!slots) {
+    return NULL;
+  }
+  for (size_t i = 0; i < count; i++) {
+    slots[i] = (uint8_t*)packet_pool_alloc(pool);
+  }
+  return slots;
+}
+
+static void vban_slots_free(vban_arena_handle_t arena, packet_pool_t* pool, uint8_t** slots, size_t count) {
+  if (!slots) {
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    packet_pool_free(pool, slots[i]);
+  }
+  vban_mem_free(arena, slots);
+}
+
+// Task stacks are set up once: supplied by the caller, carved from the arena, or allocated from internal RAM
+// (stacks must not live in PSRAM). Tasks are then created statically on that memory, with the control block in the handle.
+static StackType_t* vban_task_stack_alloc(vban_arena_handle_t arena, void* supplied, size_t size, bool* owned) {
+  *owned = false;
+  if (supplied) {
+    return (StackType_t*)supplied;
+  }
+  if (arena) {
+    return (StackType_t*)arena_alloc(&arena->arena, size, 16);
+  }
+  *owned = true;
+  return (StackType_t*)heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+// Delete a task that has been told to exit. Exiting tasks park themselves (vTaskSuspend()) instead of deleting
+// themselves, so that they can be deleted here while not running and their static memory is immediately free for
+// the next start or for release. A task is never deleted before it parks: until then it may hold the pull mutex or
+// pool buffers, or be inside lwIP. If it does not park in time, it is left running and ESP_ERR_TIMEOUT is returned.
+static esp_err_t vban_task_reap(TaskHandle_t* task) {
+  if (!*task) {
+    return ESP_OK;
+  }
+  for (uint32_t waited_ms = 0; eTaskGetState(*task) != eSuspended; waited_ms += VBAN_TASK_REAP_POLL_MS) {
+    if (waited_ms >= VBAN_TASK_REAP_TIMEOUT_MS) {
+      ESP_LOGE(TAG, "Task '%s' did not exit within %d ms", pcTaskGetName(*task), VBAN_TASK_REAP_TIMEOUT_MS);
+      return ESP_ERR_TIMEOUT;
+    }
+    vTaskDelay(pdMS_TO_TICKS(VBAN_TASK_REAP_POLL_MS));
+  }
+  vTaskDelete(*task);
+  *task = NULL;
+  return ESP_OK;
+}
+
 // --- Sender Implementation ---
 
+// Release everything owned by a sender handle, including the handle itself. Safe on partially created handles.
+static void vban_sender_free(vban_handle_t handle) {
+  if (handle->sock_fd >= 0) {
+    close(handle->sock_fd);
+    handle->sock_fd = -1;
+  }
+  packet_pool_free(handle->pool, handle->ctx.sender.tx_buffer);
+  packet_pool_free(handle->pool, handle->ctx.sender.fec_parity);
+  if (handle->pool_reserved > 0) {
+    packet_pool_unreserve(handle->pool, handle->pool_reserved);
+  }
+  vban_handle_free(handle);
+}
+
 vban_handle_t vban_sender_create(const vban_sender_config_t* config) {
   if (!config || !config->dest_ip[0] || strlen(config->stream_name) >= VBAN_STREAM_NAME_MAX_LEN) {
     ESP_LOGE(TAG, "Sender create: Invalid arguments");
     return NULL;
   }
+  if (config->fec_group_size > 0 && !vban_fec_group_size_valid(config->fec_group_size)) {
+    ESP_LOGE(TAG, "Sender create: FEC group size must be 0 or a power of two from 2 to %d", VBAN_FEC_MAX_GROUP_SIZE);
+    return NULL;
+  }
 
-  vban_handle_t handle = (vban_handle_t)calloc(1, sizeof(struct vban_instance_s));
+  dma_copy_init();  // At setup time, as the driver allocates (copies stay on the CPU if it is unavailable)
+  vban_handle_t handle = (vban_handle_t)vban_mem_alloc(config->arena, sizeof(struct vban_instance_s));
   if (!handle) {
     ESP_LOGE(TAG, "Sender create: No memory for handle");
     return NULL;
   }
 
   handle->type = VBAN_INSTANCE_TYPE_SENDER;
+  handle->sock_fd = -1;
+  vban_handle_init(handle, config->arena);
   memcpy(&handle->ctx.sender.config, config, sizeof(vban_sender_config_t));
   handle->ctx.sender.frame_counter = 0;
 
+  // Packet buffer, plus the parity packet under construction when FEC is enabled
+  const bool fec_enabled = config->fec_group_size > 0;
+  if (vban_pool_reserve(handle, fec_enabled ? 2 : 1) != ESP_OK) {
+    ESP_LOGE(TAG, "Sender create: No memory for packet buffers");
+    vban_sender_free(handle);
+    return NULL;
+  }
+  handle->ctx.sender.tx_buffer = (uint8_t*)packet_pool_alloc(handle->pool);
+  if (fec_enabled) {
+    handle->ctx.sender.fec_parity = (uint8_t*)packet_pool_alloc(handle->pool);
+    memset(handle->ctx.sender.fec_parity, 0, VBAN_PACKET_BUFFER_SIZE);
+    vban_fec_get_stream_name(config->stream_name, handle->ctx.sender.fec_stream_name);
+  }
+
   handle->sock_fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
   if (handle->sock_fd < 0) {
     ESP_LOGE(TAG, "Sender create: Failed to create socket: %s", strerror(errno));
-    free(handle);
+    vban_sender_free(handle);
     return NULL;
   }
 
@@ -129,8 +617,7 @@ vban_handle_t vban_sender_create(const vban_sender_config_t* config) {
   handle->ctx.sender.dest_addr.sin_port = htons(config->dest_port > 0 ? config->dest_port : VBAN_DEFAULT_PORT);
   if (inet_pton(AF_INET, config->dest_ip, &handle->ctx.sender.dest_addr.sin_addr) <= 0) {
     ESP_LOGE(TAG, "Sender create: Invalid destination IP address %s", config->dest_ip);
-    close(handle->sock_fd);
-    free(handle);
+    vban_sender_free(handle);
     return NULL;
   }
 
@@ -144,15 +631,49 @@ esp_err_t vban_sender_delete(vban_handle_t handle) {
     return ESP_ERR_VBAN_INVALID_HANDLE;
   }
 
-  if (handle->sock_fd >= 0) {
-    close(handle->sock_fd);
-    handle->sock_fd = -1;
-  }
   ESP_LOGI(TAG, "VBAN Sender for stream '%s' deleted", handle->ctx.sender.config.stream_name);
-  free(handle);
+  vban_sender_free(handle);
   return ESP_OK;
 }
 
+// XOR one outgoing audio packet into the parity of its group; the first packet of a group restarts the parity.
+static void vban_sender_fec_accumulate(vban_handle_t handle, const vban_header_t* header, const uint8_t* payload, size_t payload_len) {
+  const uint8_t group_size = handle->ctx.sender.config.fec_group_size;
+  uint8_t* parity = handle->ctx.sender.fec_parity;
+  uint8_t* prefix = parity + VBAN_HEADER_SIZE;
+
+  if ((header->frame_counter & (group_size - 1u)) == 0) {
+    memset(prefix, 0, VBAN_FEC_PARITY_PREFIX_SIZE + handle->ctx.sender.fec_parity_len);
+    handle->ctx.sender.fec_parity_len = 0;
+
+    vban_header_t* parity_header = (vban_header_t*)parity;
+    parity_header->vban_magic = VBAN_MAGIC_NUMBER;
+    parity_header->sr_subprotocol = (uint8_t)((header->sr_subprotocol & VBAN_SR_INDEX_MASK) | VBAN_SUBPROTOCOL_USER);
+    parity_header->samples_per_frame_m1 = group_size - 1;
+    parity_header->channels_m1 = 0;
+    parity_header->format_codec = 0;
+    memcpy(parity_header->stream_name, handle->ctx.sender.fec_stream_name, VBAN_STREAM_NAME_MAX_LEN);
+    parity_header->frame_counter = header->frame_counter;
+  }
+
+  uint32_t format_word;
+  uint32_t format_xor;
+  memcpy(&format_word, &header->sr_subprotocol, sizeof(format_word));
+  memcpy(&format_xor, prefix, sizeof(format_xor));
+  format_xor ^= format_word;
+  memcpy(prefix, &format_xor, sizeof(format_xor));
+
+  uint16_t length_xor;
+  memcpy(&length_xor, prefix + 4, sizeof(length_xor));
+  length_xor ^= (uint16_t)payload_len;
+  memcpy(prefix + 4, &length_xor, sizeof(length_xor));
+
+  vban_xor_bytes(prefix + VBAN_FEC_PARITY_PREFIX_SIZE, payload, payload_len);
+  if (payload_len > handle->ctx.sender.fec_parity_len) {
+    handle->ctx.sender.fec_parity_len = payload_len;
+  }
+}
+
 esp_err_t vban_audio_send(vban_handle_t handle, const void* audio_data, uint8_t num_samples /* 1-256 */) {
   if (!handle || handle->type != VBAN_INSTANCE_TYPE_SENDER) {
     return ESP_ERR_VBAN_INVALID_HANDLE;
@@ -174,7 +695,7 @@ esp_err_t vban_audio_send(vban_handle_t handle, const void* audio_data, uint8_t
     return ESP_ERR_VBAN_PAYLOAD_TOO_LARGE;
   }
 
-  uint8_t packet_buffer[VBAN_MAX_PACKET_SIZE];
+  uint8_t* packet_buffer = handle->ctx.sender.tx_buffer;
   vban_header_t* header = (vban_header_t*)packet_buffer;
 
   header->vban_magic = VBAN_MAGIC_NUMBER;
@@ -194,7 +715,10 @@ esp_err_t vban_audio_send(vban_handle_t handle, const void* audio_data, uint8_t
   }
   header->frame_counter = handle->ctx.sender.frame_counter++;
 
-  memcpy(packet_buffer + VBAN_HEADER_SIZE, audio_data, audio_payload_size);
+  dma_copy(packet_buffer + VBAN_HEADER_SIZE, audio_data, audio_payload_size);
+  if (handle->ctx.sender.fec_parity) {
+    vban_sender_fec_accumulate(handle, header, packet_buffer + VBAN_HEADER_SIZE, audio_payload_size);
+  }
 
   ssize_t sent_len = sendto(handle->sock_fd, packet_buffer, VBAN_HEADER_SIZE + audio_payload_size, 0,
                             (struct sockaddr*)&handle->ctx.sender.dest_addr, sizeof(handle->ctx.sender.dest_addr));
@@ -208,265 +732,2074 @@ esp_err_t vban_audio_send(vban_handle_t handle, const void* audio_data, uint8_t
     return ESP_ERR_VBAN_SEND_FAIL;  // Or a more specific error
   }
   // ESP_LOGD(TAG, "Sent VBAN audio packet, %d bytes, frame %u", sent_len, header->frame_counter -1);
+
+  // The last packet of a group completes its parity
+  const uint8_t fec_group_size = handle->ctx.sender.config.fec_group_size;
+  if (handle->ctx.sender.fec_parity && (header->frame_counter & (fec_group_size - 1u)) == fec_group_size - 1u) {
+    size_t parity_size = VBAN_HEADER_SIZE + VBAN_FEC_PARITY_PREFIX_SIZE + handle->ctx.sender.fec_parity_len;
+    sent_len = sendto(handle->sock_fd, handle->ctx.sender.fec_parity, parity_size, 0, (struct sockaddr*)&handle->ctx.sender.dest_addr,
+                      sizeof(handle->ctx.sender.dest_addr));
+    if (sent_len != (ssize_t)parity_size) {
+      ESP_LOGW(TAG, "Audio send: Parity packet for frame %u not sent", (unsigned)header->frame_counter);
+    }
+  }
   return ESP_OK;
 }
 
 // --- Receiver Implementation ---
 
-static void vban_receive_task(void* pvParameters) {
-  vban_handle_t handle = (vban_handle_t)pvParameters;
-  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
-    ESP_LOGE(TAG, "Receive task: Invalid handle passed");
-    vTaskDelete(NULL);
-    return;
-  }
+static inline uint32_t vban_header_format_word(const vban_header_t* header) {
+  uint32_t word;
+  memcpy(&word, &header->sr_subprotocol, sizeof(word));
+  return word & VBAN_FORMAT_WORD_MASK;
+}
 
-  uint8_t rx_buffer[VBAN_MAX_PACKET_SIZE];
-  struct sockaddr_in source_addr;
-  socklen_t socklen = sizeof(source_addr);
+// --- Build-time Specialization ---
 
-  ESP_LOGI(TAG, "VBAN Receiver task started for stream '%s' on port %d",
-           handle->ctx.receiver.config.expected_stream_name[0] ? handle->ctx.receiver.config.expected_stream_name : "<ANY>",
-           handle->ctx.receiver.config.listen_port);
+// Track whether the receiver follows the build-time stream, which makes vban_fast_match() compare constants.
+static void vban_receiver_update_follows_fixed(vban_handle_t handle) {
+#if CONFIG_VBAN_FIXED_FORMAT
+  handle->ctx.receiver.follows_fixed =
+      strncmp(handle->ctx.receiver.config.expected_stream_name, CONFIG_VBAN_FIXED_STREAM_NAME, VBAN_STREAM_NAME_MAX_LEN) == 0;
+#else
+  (void)handle;
+#endif
+}
 
-  handle->ctx.receiver.state = VBAN_RECEIVER_STATE_RUNNING;
+// Fast-path classification of an audio packet: its format word and payload size are those of the last fully
+// validated packet. While the receiver follows the build-time stream, the expected word is the compile-time one
+// instead, for any frame count: a masked compare with a constant and a multiply by a constant frame size.
+static inline bool vban_fast_match(vban_handle_t handle, const vban_header_t* header, uint32_t format_word, size_t audio_data_len) {
+#if CONFIG_VBAN_FIXED_FORMAT
+  if (handle->ctx.receiver.follows_fixed) {
+    return (format_word & VBAN_PASSTHROUGH_WORD_MASK) == VBAN_FIXED_FORMAT_WORD &&
+           audio_data_len == (size_t)(header->samples_per_frame_m1 + 1) * VBAN_FIXED_FRAME_BYTES;
+  }
+#else
+  (void)header;
+#endif
+  return format_word == handle->ctx.receiver.fast_format_word && audio_data_len == handle->ctx.receiver.fast_payload_size;
+}
 
-  while (handle->ctx.receiver.state == VBAN_RECEIVER_STATE_RUNNING) {
-    ssize_t len = recvfrom(handle->sock_fd, rx_buffer, sizeof(rx_buffer), 0, (struct sockaddr*)&source_addr, &socklen);
+// Bytes per frame of a packet with the pull format's rate and channels: known without a lookup when the packet is
+// already in pull_format or, in the specialized build, of the build-time sample type.
+static inline size_t vban_pull_src_frame_bytes(vban_handle_t handle, bool passthrough, vban_data_type_t src_type) {
+  if (passthrough) {
+    return handle->ctx.receiver.pull_frame_bytes;
+  }
+  const size_t num_channels = handle->ctx.receiver.config.pull_format.num_channels;
+#if CONFIG_VBAN_FIXED_FORMAT
+  if (src_type == (vban_data_type_t)CONFIG_VBAN_FIXED_DATA_TYPE) {
+    return CONFIG_VBAN_FIXED_SAMPLE_BYTES * num_channels;
+  }
+#endif
+  return vban_get_data_type_size(src_type) * num_channels;
+}
 
-    if (len < 0) {
-      if (errno == EWOULDBLOCK || errno == EAGAIN) {  // Non-blocking socket would return this
-        vTaskDelay(pdMS_TO_TICKS(10));                // Avoid busy loop if socket is non-blocking (not set here)
-        continue;
-      }
-      if (handle->ctx.receiver.state != VBAN_RECEIVER_STATE_RUNNING) {  // Socket closed during stop
-        break;
-      }
-      ESP_LOGE(TAG, "Receive task: recvfrom failed: %s", strerror(errno));
-      vTaskDelay(pdMS_TO_TICKS(100));  // Wait a bit before retrying on error
-      continue;
-    }
+// Convert received samples into the pull format, with the converter specialized for the build-time type if it applies.
+// The levels of the samples are added to meter (NULL without metering).
+static inline esp_err_t vban_pull_convert(void* dst, vban_data_type_t dst_type, const void* src, vban_data_type_t src_type,
+                                          size_t num_samples, level_meter_acc_t* meter) {
+#if CONFIG_VBAN_FIXED_FORMAT
+  if (src_type == (vban_data_type_t)CONFIG_VBAN_FIXED_DATA_TYPE) {
+    return pcm_convert_from_fixed(dst, dst_type, src, num_samples, meter);
+  }
+#endif
+  return pcm_convert_metered(dst, dst_type, src, src_type, num_samples, meter);
+}
 
-    if (len < VBAN_HEADER_SIZE) {
-      ESP_LOGD(TAG, "Receive task: Packet too short (%d bytes)", (int)len);
-      continue;
+// --- Stream Switching ---
+
+// End a crossfade: the new stream's staged frames go to the pull ring, the old stream's are dropped.
+// Called with pull_mutex held. Returns true if frames were committed.
+static HOT_PATH_ATTR bool vban_crossfade_finish(vban_handle_t handle) {
+  vban_crossfade_rx_t* crossfade = &handle->ctx.receiver.crossfade;
+  bool committed = false;
+  size_t new_bytes = 0;
+  const void* new_data = circular_buffer_get_readable_region(&crossfade->stage_new, &new_bytes);
+  if (new_data && new_bytes > 0) {
+    if (circular_buffer_write(&handle->ctx.receiver.pull_ring, new_data, new_bytes) == CB_SUCCESS) {
+      committed = true;
+    } else {
+      handle->ctx.receiver.deliver_stats.pull_overruns++;
     }
+  }
+  circular_buffer_consume(&crossfade->stage_new, circular_buffer_get_count(&crossfade->stage_new));
+  circular_buffer_consume(&crossfade->stage_old, circular_buffer_get_count(&crossfade->stage_old));
+  crossfade->active = false;  // Old packets already accepted are still flagged as such and dropped
+  return committed;
+}
 
-    vban_header_t* header = (vban_header_t*)rx_buffer;
+// Mix the frames that both streams have staged into the pull ring. Called with pull_mutex held.
+// Returns true if frames were committed.
+static HOT_PATH_ATTR bool vban_crossfade_mix(vban_handle_t handle) {
+  vban_crossfade_rx_t* crossfade = &handle->ctx.receiver.crossfade;
+  const vban_audio_format_t* fmt = &handle->ctx.receiver.config.pull_format;
+  const size_t frame_bytes = handle->ctx.receiver.pull_frame_bytes;
+
+  size_t old_bytes = 0;
+  size_t new_bytes = 0;
+  const void* old_data = circular_buffer_get_readable_region(&crossfade->stage_old, &old_bytes);
+  const void* new_data = circular_buffer_get_readable_region(&crossfade->stage_new, &new_bytes);
+  size_t frames = (old_bytes < new_bytes ? old_bytes : new_bytes) / frame_bytes;
+  if (frames == 0) {
+    return false;
+  }
 
-    if (header->vban_magic != VBAN_MAGIC_NUMBER) {
-      ESP_LOGD(TAG, "Receive task: Invalid VBAN magic number 0x%08X", (unsigned int)header->vban_magic);
-      continue;
-    }
+  bool committed = false;
+  size_t writable_bytes = 0;
+  void* region = circular_buffer_get_writable_region(&handle->ctx.receiver.pull_ring, &writable_bytes);
+  if (region && writable_bytes >= frames * frame_bytes) {
+    memcpy(region, old_data, frames * frame_bytes);
+    pcm_crossfade(region, new_data, fmt->data_type, fmt->num_channels, frames, &crossfade->fade);
+    circular_buffer_commit(&handle->ctx.receiver.pull_ring, frames * frame_bytes);
+    committed = true;
+  } else {
+    handle->ctx.receiver.deliver_stats.pull_overruns++;
+  }
+  circular_buffer_consume(&crossfade->stage_old, frames * frame_bytes);
+  circular_buffer_consume(&crossfade->stage_new, frames * frame_bytes);
+
+  if (crossfade->fade.remaining == 0) {
+    committed |= vban_crossfade_finish(handle);
+  }
+  return committed;
+}
 
-    // Optional: Filter by stream name
-    if (handle->ctx.receiver.config.expected_stream_name[0] != '\0') {
-      // Null-terminate received name for safe comparison if it's shorter than max
-      char received_stream_name[VBAN_STREAM_NAME_MAX_LEN + 1];
-      memcpy(received_stream_name, header->stream_name, VBAN_STREAM_NAME_MAX_LEN);
-      received_stream_name[VBAN_STREAM_NAME_MAX_LEN] = '\0';
+// Apply a pending vban_receiver_select_stream() request. Runs in the receiving task.
+static HOT_PATH_ATTR void vban_receiver_apply_stream_request(vban_handle_t handle) {
+  vban_crossfade_rx_t* crossfade = &handle->ctx.receiver.crossfade;
+  vban_receiver_config_t* cfg = &handle->ctx.receiver.config;
+  char name[VBAN_STREAM_NAME_MAX_LEN];
+  uint32_t crossfade_ms;
 
-      if (strncmp(handle->ctx.receiver.config.expected_stream_name, received_stream_name, VBAN_STREAM_NAME_MAX_LEN) != 0) {
-        ESP_LOGD(TAG, "Receive task: Stream name mismatch. Expected '%s', got '%s'", handle->ctx.receiver.config.expected_stream_name,
-                 received_stream_name);
-        continue;
-      }
+  portENTER_CRITICAL(&crossfade->request_lock);
+  memcpy(name, crossfade->request_name, sizeof(name));
+  crossfade_ms = crossfade->request_ms;
+  crossfade->request_pending = false;
+  portEXIT_CRITICAL(&crossfade->request_lock);
+
+  if (strncmp(name, cfg->expected_stream_name, VBAN_STREAM_NAME_MAX_LEN) == 0) {
+    return;
+  }
+
+  if (cfg->pull_enabled) {
+    bool committed = false;
+    xSemaphoreTake(handle->ctx.receiver.pull_mutex, portMAX_DELAY);
+    if (crossfade->active) {
+      committed = vban_crossfade_finish(handle);
     }
+    memset(crossfade->old_name, 0, sizeof(crossfade->old_name));
+    if (crossfade_ms > 0 && crossfade->stage_old.is_initialized) {
+      size_t frames = (size_t)crossfade_ms * vban_get_sr_from_index(cfg->pull_format.sample_rate_idx) / 1000;
+      memcpy(crossfade->old_name, cfg->expected_stream_name, VBAN_STREAM_NAME_MAX_LEN);
+      pcm_crossfade_init(&crossfade->fade, frames);
+      crossfade->active = true;
+    }
+    xSemaphoreGive(handle->ctx.receiver.pull_mutex);
+    if (committed) {
+      xSemaphoreGive(handle->ctx.receiver.pull_data_ready);
+    }
+  }
 
-    vban_sample_rate_index_t sr_idx;
-    uint8_t sub_protocol_id;
-    vban_util_parse_sr_subprotocol_byte(header->sr_subprotocol, &sr_idx, &sub_protocol_id);
-
-    if (sub_protocol_id == (VBAN_SUBPROTOCOL_AUDIO >> VBAN_SUBPROTOCOL_SHIFT)) {  // Compare shifted value
-      if (handle->ctx.receiver.config.audio_callback) {
-        const uint8_t* audio_data = rx_buffer + VBAN_HEADER_SIZE;
-        size_t audio_data_len = len - VBAN_HEADER_SIZE;
-
-        // Optional: Validate audio_data_len based on header info
-        vban_data_type_t data_type;
-        uint8_t codec_id;
-        bool reserved_bit;
-        vban_util_parse_format_codec_byte(header->format_codec, &data_type, &codec_id, &reserved_bit);
-        if (codec_id == (VBAN_CODEC_PCM >> VBAN_CODEC_SHIFT)) {  // Compare shifted value
-          size_t expected_payload_size =
-              (size_t)(header->samples_per_frame_m1 + 1) * (header->channels_m1 + 1) * vban_get_data_type_size(data_type);
-          if (audio_data_len != expected_payload_size) {
-            ESP_LOGW(TAG, "Receive task: Audio data size mismatch. Expected %d, got %d. Frame %u, Stream '%s'", expected_payload_size,
-                     audio_data_len, (unsigned)header->frame_counter, header->stream_name);
-            // continue; // Or process anyway, depending on strictness
-          }
+  memcpy(cfg->expected_stream_name, name, VBAN_STREAM_NAME_MAX_LEN);
+  vban_receiver_update_follows_fixed(handle);
+  ESP_LOGI(TAG, "Receiver: Following stream '%s'", name);
+}
 
-          char sender_ip_str[16];
-          inet_ntoa_r(source_addr.sin_addr, sender_ip_str, sizeof(sender_ip_str));
+// --- Stream Discovery ---
 
-          handle->ctx.receiver.config.audio_callback(header, audio_data, audio_data_len, sender_ip_str, ntohs(source_addr.sin_port),
-                                                     handle->ctx.receiver.config.user_context);
-        } else {
-          ESP_LOGD(TAG, "Receive task: Received audio packet with unsupported codec ID %d", codec_id);
-        }
+static inline bool vban_discovery_match(const vban_discovery_entry_t* entry, const vban_header_t* header, const vban_packet_desc_t* desc) {
+  return entry->used && entry->info.sender_id == desc->sender_id && entry->info.sender_port == desc->sender_port &&
+         memcmp(entry->info.stream_name, header->stream_name, VBAN_STREAM_NAME_MAX_LEN) == 0;
+}
+
+// Record an audio packet in the discovery table. Called for every valid audio packet before the stream name filter.
+static HOT_PATH_ATTR void vban_discovery_observe(vban_handle_t handle, const vban_header_t* header, const vban_packet_desc_t* desc) {
+  vban_discovery_rx_t* discovery = &handle->ctx.receiver.discovery;
+  const int64_t timeout_us = (int64_t)VBAN_DISCOVERY_TIMEOUT_MS * 1000;
+
+  portENTER_CRITICAL(&discovery->lock);
+  // Incremental aging: one entry per packet
+  vban_discovery_entry_t* aged = &discovery->entries[discovery->age_cursor];
+  if (aged->used && desc->arrival_time_us - aged->info.last_seen_us > timeout_us) {
+    aged->used = false;
+  }
+  discovery->age_cursor = (discovery->age_cursor + 1) % VBAN_DISCOVERY_MAX_STREAMS;
+
+  vban_discovery_entry_t* entry = &discovery->entries[discovery->last_hit];
+  if (!vban_discovery_match(entry, header, desc)) {
+    entry = NULL;
+    size_t victim = 0;  // Free entry, else the least recently seen one
+    for (size_t i = 0; i < VBAN_DISCOVERY_MAX_STREAMS; i++) {
+      vban_discovery_entry_t* candidate = &discovery->entries[i];
+      if (vban_discovery_match(candidate, header, desc)) {
+        entry = candidate;
+        discovery->last_hit = i;
+        break;
       }
-    } else {
-      // ESP_LOGD(TAG, "Receive task: Received packet with sub-protocol %d (not audio)", sub_protocol_id);
-      // Future: Handle other sub-protocols here
+      const vban_discovery_entry_t* current = &discovery->entries[victim];
+      if (current->used && (!candidate->used || candidate->info.last_seen_us < current->info.last_seen_us)) {
+        victim = i;
+      }
+    }
+    if (!entry) {
+      entry = &discovery->entries[victim];
+      memset(entry, 0, sizeof(*entry));
+      memcpy(entry->info.stream_name, header->stream_name, VBAN_STREAM_NAME_MAX_LEN);
+      entry->info.sender_id = desc->sender_id;
+      entry->info.sender_port = desc->sender_port;
+      entry->last_frame = header->frame_counter - 1;
+      entry->used = true;
+      discovery->last_hit = victim;
     }
   }
 
-  ESP_LOGI(TAG, "VBAN Receiver task for stream '%s' stopping.",
-           handle->ctx.receiver.config.expected_stream_name[0] ? handle->ctx.receiver.config.expected_stream_name : "<ANY>");
-  handle->ctx.receiver.receive_task_handle = NULL;  // Clear task handle as it's about to be deleted or has exited
-  handle->ctx.receiver.state = VBAN_RECEIVER_STATE_IDLE;
-  vTaskDelete(NULL);  // Task deletes itself
+  // Packets after the first one update the rate and the loss estimate
+  if (entry->info.packets > 0) {
+    uint32_t interval = (uint32_t)(desc->arrival_time_us - entry->info.last_seen_us);
+    if (entry->interval_us == 0) {
+      entry->interval_us = interval;
+    } else {
+      entry->interval_us = entry->interval_us - (entry->interval_us >> VBAN_DISCOVERY_INTERVAL_SHIFT) +
+                           (interval >> VBAN_DISCOVERY_INTERVAL_SHIFT);
+    }
+    uint32_t gap = header->frame_counter - entry->last_frame;  // Wraps safely
+    if (gap > 1 && gap <= VBAN_DISCOVERY_MAX_GAP) {
+      entry->info.lost += gap - 1;
+    }
+  }
+  entry->last_frame = header->frame_counter;
+  entry->info.packets++;
+  entry->info.last_seen_us = desc->arrival_time_us;
+  entry->info.format.sample_rate_idx = (vban_sample_rate_index_t)(header->sr_subprotocol & VBAN_SR_INDEX_MASK);
+  entry->info.format.num_channels = header->channels_m1 + 1;
+  entry->info.format.data_type = (vban_data_type_t)(header->format_codec & VBAN_DATATYPE_MASK);
+  entry->info.frames_per_packet = header->samples_per_frame_m1 + 1;
+  portEXIT_CRITICAL(&discovery->lock);
 }
 
-vban_handle_t vban_receiver_create(const vban_receiver_config_t* config) {
-  if (!config || !config->audio_callback) {  // audio_callback is mandatory for now
-    ESP_LOGE(TAG, "Receiver create: Invalid arguments (callback missing)");
-    return NULL;
-  }
-  if (strlen(config->expected_stream_name) >= VBAN_STREAM_NAME_MAX_LEN) {
-    ESP_LOGE(TAG, "Receiver create: Expected stream name too long");
-    return NULL;
+// Validate a received datagram. Returns true and fills desc if it is an acceptable audio packet.
+static HOT_PATH_ATTR bool vban_receiver_accept_packet(vban_handle_t handle, const uint8_t* packet, ssize_t len, vban_packet_desc_t* desc) {
+  if (handle->ctx.receiver.crossfade.request_pending) {
+    vban_receiver_apply_stream_request(handle);
   }
 
-  vban_handle_t handle = (vban_handle_t)calloc(1, sizeof(struct vban_instance_s));
-  if (!handle) {
-    ESP_LOGE(TAG, "Receiver create: No memory for handle");
-    return NULL;
+  if (len < VBAN_HEADER_SIZE) {
+    ESP_LOGD(TAG, "Receive task: Packet too short (%d bytes)", (int)len);
+    return false;
   }
 
-  handle->type = VBAN_INSTANCE_TYPE_RECEIVER;
-  memcpy(&handle->ctx.receiver.config, config, sizeof(vban_receiver_config_t));
-  handle->ctx.receiver.state = VBAN_RECEIVER_STATE_IDLE;
-  handle->ctx.receiver.receive_task_handle = NULL;
+  const vban_header_t* header = (const vban_header_t*)packet;
 
-  handle->sock_fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-  if (handle->sock_fd < 0) {
-    ESP_LOGE(TAG, "Receiver create: Failed to create socket: %s", strerror(errno));
-    free(handle);
-    return NULL;
+  if (header->vban_magic != VBAN_MAGIC_NUMBER) {
+    ESP_LOGD(TAG, "Receive task: Invalid VBAN magic number 0x%08X", (unsigned int)header->vban_magic);
+    return false;
   }
 
-  // Set socket to be non-blocking (optional, can help with cleaner task shutdown)
-  // int flags = fcntl(handle->sock_fd, F_GETFL, 0);
-  // fcntl(handle->sock_fd, F_SETFL, flags | O_NONBLOCK);
+  // Parity packets of the companion stream bypass the stream name filter and the audio checks
+  if (handle->ctx.receiver.config.fec_group_size > 0 && (header->sr_subprotocol & VBAN_SUBPROTOCOL_MASK) == VBAN_SUBPROTOCOL_USER &&
+      memcmp(header->stream_name, handle->ctx.receiver.fec.stream_name, VBAN_STREAM_NAME_MAX_LEN) == 0) {
+    if (len < VBAN_HEADER_SIZE + VBAN_FEC_PARITY_PREFIX_SIZE) {
+      return false;
+    }
+    desc->header = header;
+    desc->audio_data = packet + VBAN_HEADER_SIZE;
+    desc->audio_data_len = len - VBAN_HEADER_SIZE;
+    return true;
+  }
+  if (len > VBAN_MAX_PACKET_SIZE) {  // Receive buffers are larger than audio packets to fit parity packets
+    ESP_LOGD(TAG, "Receive task: Packet too long (%d bytes)", (int)len);
+    return false;
+  }
+  if (handle->ctx.receiver.config.discovery_enabled && (header->sr_subprotocol & VBAN_SUBPROTOCOL_MASK) == VBAN_SUBPROTOCOL_AUDIO) {
+    vban_discovery_observe(handle, header, desc);
+  }
 
-  struct sockaddr_in server_addr;
-  memset(&server_addr, 0, sizeof(server_addr));
-  server_addr.sin_family = AF_INET;
-  server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-  server_addr.sin_port = htons(config->listen_port > 0 ? config->listen_port : VBAN_DEFAULT_PORT);
+  // Optional: Filter by stream name (a 16-byte compare with a constant for the build-time stream)
+#if CONFIG_VBAN_FIXED_FORMAT
+  const bool fixed_name =
+      handle->ctx.receiver.follows_fixed && memcmp(header->stream_name, s_fixed_stream_name, VBAN_STREAM_NAME_MAX_LEN) == 0;
+#else
+  const bool fixed_name = false;
+#endif
+  if (!fixed_name && handle->ctx.receiver.config.expected_stream_name[0] != '\0') {
+    // Null-terminate received name for safe comparison if it's shorter than max
+    char received_stream_name[VBAN_STREAM_NAME_MAX_LEN + 1];
+    memcpy(received_stream_name, header->stream_name, VBAN_STREAM_NAME_MAX_LEN);
+    received_stream_name[VBAN_STREAM_NAME_MAX_LEN] = '\0';
+
+    if (strncmp(handle->ctx.receiver.config.expected_stream_name, received_stream_name, VBAN_STREAM_NAME_MAX_LEN) != 0 &&
+        (!handle->ctx.receiver.config.backup_stream_name[0] ||
+         strncmp(handle->ctx.receiver.config.backup_stream_name, received_stream_name, VBAN_STREAM_NAME_MAX_LEN) != 0) &&
+        (!handle->ctx.receiver.crossfade.active ||
+         strncmp(handle->ctx.receiver.crossfade.old_name, received_stream_name, VBAN_STREAM_NAME_MAX_LEN) != 0)) {
+      ESP_LOGD(TAG, "Receive task: Stream name mismatch. Expected '%s', got '%s'", handle->ctx.receiver.config.expected_stream_name,
+               received_stream_name);
+      return false;
+    }
+  }
 
-  if (bind(handle->sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-    ESP_LOGE(TAG, "Receiver create: Failed to bind socket to port %d: %s", ntohs(server_addr.sin_port), strerror(errno));
-    close(handle->sock_fd);
-    free(handle);
-    return NULL;
+  size_t audio_data_len = len - VBAN_HEADER_SIZE;
+
+  // Fast path: same SR, sub-protocol, frame size, channels and format as the last validated packet (or the build-time
+  // stream), so one masked compare and one length compare replace the parse and the size arithmetic below.
+  uint32_t format_word = vban_header_format_word(header);
+  if (vban_fast_match(handle, header, format_word, audio_data_len)) {
+    handle->ctx.receiver.stats.fast_path_packets++;
+    goto accept;
   }
 
-  ESP_LOGI(TAG, "VBAN Receiver created for stream '%s' on port %d",
-           config->expected_stream_name[0] ? config->expected_stream_name : "<ANY>", ntohs(server_addr.sin_port));
-  return handle;
-}
+  vban_sample_rate_index_t sr_idx;
+  uint8_t sub_protocol_id;
+  vban_util_parse_sr_subprotocol_byte(header->sr_subprotocol, &sr_idx, &sub_protocol_id);
 
-esp_err_t vban_receiver_delete(vban_handle_t handle) {
-  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
-    return ESP_ERR_VBAN_INVALID_HANDLE;
+  if (sub_protocol_id != (VBAN_SUBPROTOCOL_AUDIO >> VBAN_SUBPROTOCOL_SHIFT)) {  // Compare shifted value
+    // ESP_LOGD(TAG, "Receive task: Received packet with sub-protocol %d (not audio)", sub_protocol_id);
+    // Future: Handle other sub-protocols here
+    return false;
   }
 
-  esp_err_t err = vban_receiver_stop(handle);  // Ensure task is stopped
-  if (err != ESP_OK && err != ESP_ERR_VBAN_NOT_STARTED) {
-    ESP_LOGW(TAG, "Receiver delete: Failed to stop task cleanly, but proceeding with delete.");
+  // Optional: Validate audio_data_len based on header info
+  vban_data_type_t data_type;
+  uint8_t codec_id;
+  bool reserved_bit;
+  vban_util_parse_format_codec_byte(header->format_codec, &data_type, &codec_id, &reserved_bit);
+  if (codec_id != (VBAN_CODEC_PCM >> VBAN_CODEC_SHIFT)) {  // Compare shifted value
+    ESP_LOGD(TAG, "Receive task: Received audio packet with unsupported codec ID %d", codec_id);
+    return false;
   }
-  // Wait a bit for the task to fully exit if it was running
-  if (handle->ctx.receiver.receive_task_handle != NULL) {
-    // This check might be racy if task deletes itself and sets handle to NULL.
-    // A more robust way is to use a semaphore or event group for task exit confirmation.
-    vTaskDelay(pdMS_TO_TICKS(50));
+  size_t expected_payload_size =
+      (size_t)(header->samples_per_frame_m1 + 1) * (header->channels_m1 + 1) * vban_get_data_type_size(data_type);
+  if (audio_data_len != expected_payload_size) {
+    ESP_LOGW(TAG, "Receive task: Audio data size mismatch. Expected %d, got %d. Frame %u, Stream '%s'", expected_payload_size,
+             audio_data_len, (unsigned)header->frame_counter, header->stream_name);
+    // return false; // Or process anyway, depending on strictness
+  } else {
+    // Learn this format for the fast path
+    handle->ctx.receiver.fast_format_word = format_word;
+    handle->ctx.receiver.fast_payload_size = expected_payload_size;
   }
 
-  if (handle->sock_fd >= 0) {
-    close(handle->sock_fd);
-    handle->sock_fd = -1;
-  }
-  ESP_LOGI(TAG, "VBAN Receiver for stream '%s' deleted",
-           handle->ctx.receiver.config.expected_stream_name[0] ? handle->ctx.receiver.config.expected_stream_name : "<ANY>");
-  free(handle);
-  return ESP_OK;
+accept:
+  handle->ctx.receiver.stats.packets_accepted++;
+  desc->header = header;
+  desc->audio_data = packet + VBAN_HEADER_SIZE;
+  desc->audio_data_len = audio_data_len;
+  return true;
 }
 
-esp_err_t vban_receiver_start(vban_handle_t handle) {
-  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
-    return ESP_ERR_VBAN_INVALID_HANDLE;
+// Hand a drained batch to the application, either as one batch or packet by packet.
+static HOT_PATH_ATTR void vban_receiver_dispatch(vban_handle_t handle, const vban_packet_desc_t* packets, size_t num_packets) {
+  const vban_receiver_config_t* cfg = &handle->ctx.receiver.config;
+  if (cfg->audio_batch_callback) {
+    cfg->audio_batch_callback(packets, num_packets, cfg->user_context);
+    return;
   }
-  if (handle->ctx.receiver.state != VBAN_RECEIVER_STATE_IDLE || handle->ctx.receiver.receive_task_handle != NULL) {
-    ESP_LOGW(TAG, "Receiver start: Already started or not idle.");
-    return ESP_ERR_VBAN_ALREADY_STARTED;  // Or ESP_ERR_VBAN_INVALID_STATE
+  if (!cfg->audio_callback) {  // Pull-only receiver
+    return;
   }
 
-  // Use configured or default task parameters
-  const vban_receiver_config_t* cfg = &handle->ctx.receiver.config;
-  BaseType_t xReturned = xTaskCreatePinnedToCore(vban_receive_task,
-                                                 "vban_rx_task",                                                         // Task name
-                                                 cfg->task_stack_size > 0 ? cfg->task_stack_size : 4096,                 // Stack size
-                                                 (void*)handle,                                                          // Parameter
-                                                 cfg->task_priority > 0 ? cfg->task_priority : (tskIDLE_PRIORITY + 5),   // Priority
-                                                 &handle->ctx.receiver.receive_task_handle,                              // Task handle
-                                                 cfg->core_id == 0 || cfg->core_id == 1 ? cfg->core_id : tskNO_AFFINITY  // Core ID
-  );
-
-  if (xReturned != pdPASS) {
-    handle->ctx.receiver.receive_task_handle = NULL;
-    ESP_LOGE(TAG, "Receiver start: Failed to create receiver task");
-    return ESP_ERR_VBAN_TASK_CREATE_FAIL;
+  for (size_t i = 0; i < num_packets; i++) {
+    char sender_ip_str[16];
+    struct in_addr sender_addr = {.s_addr = packets[i].sender_id};
+    inet_ntoa_r(sender_addr, sender_ip_str, sizeof(sender_ip_str));
+
+    cfg->audio_callback(packets[i].header, packets[i].audio_data, packets[i].audio_data_len, sender_ip_str, packets[i].sender_port,
+                        cfg->user_context);
   }
-  // State will be updated by the task itself once it starts running.
-  // Add a small delay to allow task to start and set its state.
-  vTaskDelay(pdMS_TO_TICKS(10));
-  return ESP_OK;
 }
 
-esp_err_t vban_receiver_stop(vban_handle_t handle) {
-  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
-    return ESP_ERR_VBAN_INVALID_HANDLE;
+// Record the path packets take into the pull ring, logging when it changes (at format lock or after a format change).
+static inline void vban_receiver_set_pull_path(vban_handle_t handle, vban_pull_path_t path) {
+  if (handle->ctx.receiver.deliver_stats.pull_path != path) {
+    handle->ctx.receiver.deliver_stats.pull_path = path;
+    ESP_LOGI(TAG, "Pull: %s path active", path == VBAN_PULL_PATH_PASSTHROUGH ? "Passthrough" : "Conversion");
   }
+}
 
-  if (handle->ctx.receiver.state != VBAN_RECEIVER_STATE_RUNNING || !handle->ctx.receiver.receive_task_handle) {
-    ESP_LOGI(TAG, "Receiver stop: Not running or no task handle.");
-    // If task was created but never ran or already exited, set to idle.
+// While the silence gate is idle, check a packet with a read-only peak scan: silent ones are dropped before
+// conversion, the first loud one re-opens the gate and is played whole. Returns true if the packet is dropped.
+static HOT_PATH_ATTR bool vban_gate_skip(vban_handle_t handle, const void* data, vban_data_type_t type, size_t num_samples) {
+  vban_gate_rx_t* gate = &handle->ctx.receiver.gate;
+  if (!gate->idle) {
+    return false;
+  }
+  if (pcm_peak(data, type, num_samples) <= gate->open_level) {
+    handle->ctx.receiver.deliver_stats.gate_idle_packets++;
+    return true;
+  }
+  gate->idle = false;
+  gate->silent_frames = 0;
+  ESP_LOGD(TAG, "Pull: Signal, silence gate re-opened");
+  return false;
+}
+
+// Track silence from the levels of a packet converted into region (not committed yet). When the hold time is
+// reached, the packet, already below the threshold, is ramped down to zero and the gate goes idle.
+static HOT_PATH_ATTR void vban_gate_update(vban_handle_t handle, void* region, const level_meter_acc_t* packet, size_t frames) {
+  vban_gate_rx_t* gate = &handle->ctx.receiver.gate;
+  if (packet->peak > gate->close_level) {
+    gate->silent_frames = 0;
+    return;
+  }
+  gate->silent_frames += frames;
+  if (gate->silent_frames < gate->hold_frames) {
+    return;
+  }
+  const vban_audio_format_t* fmt = &handle->ctx.receiver.config.pull_format;
+  pcm_ramp(region, fmt->data_type, fmt->num_channels, frames, 1.0f, 0.0f);
+  gate->idle = true;
+  handle->ctx.receiver.deliver_stats.gate_closes++;
+  ESP_LOGD(TAG, "Pull: Silence, gate idle");
+}
+
+// Convert a batch into the pull ring. One lock and one reader wakeup per batch. old_stream: the packets belong to the
+// stream faded out by the last switch (see vban_crossfade_is_old()).
+static HOT_PATH_ATTR void vban_receiver_pull_feed(vban_handle_t handle, const vban_packet_desc_t* packets, size_t num_packets,
+                                                  bool old_stream) {
+  const vban_audio_format_t* fmt = &handle->ctx.receiver.config.pull_format;
+  bool committed = false;
+  // Levels of the batch, accumulated by the conversion loops and published once per batch
+  level_meter_acc_t levels = {0};
+  level_meter_acc_t* meter = handle->ctx.receiver.config.metering_enabled ? &levels : NULL;
+
+  xSemaphoreTake(handle->ctx.receiver.pull_mutex, portMAX_DELAY);
+  for (size_t i = 0; i < num_packets; i++) {
+    const vban_header_t* header = packets[i].header;
+    // Accepted packets are PCM audio (see vban_receiver_accept_packet()): the format word, masked, decides the rest
+    const uint32_t format_word = vban_header_format_word(header);
+    if ((format_word & VBAN_PULL_WORD_MASK) != (handle->ctx.receiver.passthrough_word & VBAN_PULL_WORD_MASK)) {
+      ESP_LOGV(TAG, "Pull: Dropping packet with SR index %d and %d channels", header->sr_subprotocol & VBAN_SR_INDEX_MASK,
+               header->channels_m1 + 1);
+      continue;
+    }
+    const size_t num_channels = fmt->num_channels;
+    const vban_data_type_t src_type = (vban_data_type_t)(header->format_codec & VBAN_DATATYPE_MASK);
+    const bool passthrough = (format_word & VBAN_PASSTHROUGH_WORD_MASK) == handle->ctx.receiver.passthrough_word;
+    const size_t src_frame_bytes = vban_pull_src_frame_bytes(handle, passthrough, src_type);
+    if (src_frame_bytes == 0) {
+      ESP_LOGV(TAG, "Pull: Dropping packet with unsupported data type %d", src_type);
+      continue;
+    }
+
+    size_t frames = packets[i].audio_data_len / src_frame_bytes;
+    size_t bytes = frames * handle->ctx.receiver.pull_frame_bytes;
+    size_t writable_bytes = 0;
+
+    // While switching streams, both are staged and only their crossfade reaches the ring
+    vban_crossfade_rx_t* crossfade = &handle->ctx.receiver.crossfade;
+    const bool is_old = old_stream;
+    if (is_old && !crossfade->active) {
+      continue;  // Accepted before the crossfade completed
+    }
+    if (crossfade->active) {
+      circular_buffer_t* stage = is_old ? &crossfade->stage_old : &crossfade->stage_new;
+      void* stage_region = circular_buffer_get_writable_region(stage, &writable_bytes);
+      if (stage_region && writable_bytes >= bytes) {
+        level_meter_acc_t* stage_meter = is_old ? NULL : meter;  // Only the stream being switched to is metered
+        const size_t num_samples = frames * num_channels;
+        if (vban_pull_convert(stage_region, fmt->data_type, packets[i].audio_data, src_type, num_samples, stage_meter) == ESP_OK) {
+          circular_buffer_commit(stage, bytes);
+          committed |= vban_crossfade_mix(handle);
+          vban_receiver_set_pull_path(handle, VBAN_PULL_PATH_CONVERT);
+        }
+        continue;
+      }
+      // One stream stalled while the other filled its stage: complete the switch now
+      committed |= vban_crossfade_finish(handle);
+      if (is_old) {
+        continue;
+      }
+    }
+
+    const bool gated = handle->ctx.receiver.config.silence_gate_ms > 0;
+    if (gated && vban_gate_skip(handle, packets[i].audio_data, src_type, frames * num_channels)) {
+      continue;
+    }
+    void* region = circular_buffer_get_writable_region(&handle->ctx.receiver.pull_ring, &writable_bytes);
+    if (!region || writable_bytes < bytes) {
+      handle->ctx.receiver.deliver_stats.pull_overruns++;
+      ESP_LOGD(TAG, "Pull: Ring full, dropping frame %u (%u overruns)", (unsigned)header->frame_counter,
+               (unsigned)handle->ctx.receiver.deliver_stats.pull_overruns);
+      continue;
+    }
+    // Levels of the packet, for the meter and the silence gate
+    level_meter_acc_t packet_levels = {0};
+    level_meter_acc_t* packet_meter = meter || gated ? &packet_levels : NULL;
+    if (passthrough && !packet_meter) {
+      // Already in pull_format: the payload is copied into the ring as-is. Unless the buffered frames straddle the end
+      // of the ring (the ring then mirrors the copy, see circular_buffer_write()), this is the only copy after recvfrom()
+      circular_buffer_write(&handle->ctx.receiver.pull_ring, packets[i].audio_data, bytes);
+    } else {
+      // Convert straight into the ring, no staging copy. Passthrough packets take the identity kernel here, which
+      // copies them as-is as well while it meters them
+      if (vban_pull_convert(region, fmt->data_type, packets[i].audio_data, src_type, frames * num_channels, packet_meter) != ESP_OK) {
+        continue;
+      }
+      if (gated) {
+        vban_gate_update(handle, region, &packet_levels, frames);
+      }
+      circular_buffer_commit(&handle->ctx.receiver.pull_ring, bytes);
+      if (meter) {
+        level_meter_acc_merge(meter, &packet_levels, packet_levels.samples);
+      }
+    }
+    if (passthrough) {
+      handle->ctx.receiver.deliver_stats.passthrough_packets++;
+    }
+    vban_receiver_set_pull_path(handle, passthrough ? VBAN_PULL_PATH_PASSTHROUGH : VBAN_PULL_PATH_CONVERT);
+    committed = true;
+  }
+  xSemaphoreGive(handle->ctx.receiver.pull_mutex);
+
+  if (committed) {
+    xSemaphoreGive(handle->ctx.receiver.pull_data_ready);
+  }
+  if (meter && levels.samples > 0) {
+    level_meter_add(&handle->ctx.receiver.meter, &levels);
+  }
+}
+
+// Drain up to max_packets datagrams from the receiver's socket into the given slots and describe the accepted
+// ones in descs; accepted packets fill the first slots, in order. With block_first, the first recvfrom() blocks
+// (dedicated task); otherwise the socket is only drained (reactor, after select() reported it readable).
+// Returns the number of accepted packets.
+static HOT_PATH_ATTR size_t vban_receiver_drain(vban_handle_t handle, uint8_t** slots, vban_packet_desc_t* descs, size_t max_packets,
+                                                bool block_first) {
+  struct sockaddr_in source_addr;
+  socklen_t socklen;
+  size_t num_packets = 0;
+
+  for (size_t reads = 0; reads < max_packets; reads++) {
+    uint8_t* rx_buffer = slots[num_packets];  // A rejected datagram leaves its slot to the next one
+    int flags = (reads == 0 && block_first) ? 0 : MSG_DONTWAIT;
+    bool blocking = (flags == 0);
+    socklen = sizeof(source_addr);
+    ssize_t len = recvfrom(handle->sock_fd, rx_buffer, VBAN_PACKET_BUFFER_SIZE, flags, (struct sockaddr*)&source_addr, &socklen);
+
+    if (len < 0) {
+      if (errno == EWOULDBLOCK || errno == EAGAIN) {  // Socket drained, or receive timeout (the caller re-checks its state)
+        break;
+      }
+      if (handle->ctx.receiver.state != VBAN_RECEIVER_STATE_RUNNING) {  // Socket closed during stop
+        break;
+      }
+      ESP_LOGE(TAG, "Receive task: recvfrom failed: %s", strerror(errno));
+      if (blocking) {
+        vTaskDelay(pdMS_TO_TICKS(100));  // Wait a bit before retrying on error
+      }
+      break;
+    }
+    handle->ctx.receiver.stats.packets_received++;
+
+    vban_packet_desc_t* desc = &descs[num_packets];
+    desc->arrival_time_us = esp_timer_get_time();  // Filled first for stream discovery
+    desc->sender_id = source_addr.sin_addr.s_addr;
+    desc->sender_port = ntohs(source_addr.sin_port);
+    if (!vban_receiver_accept_packet(handle, rx_buffer, len, desc)) {
+      continue;  // The slot is reused by the next datagram
+    }
+    num_packets++;
+  }
+  return num_packets;
+}
+
+// Whether a packet belongs to the stream faded out by the last switch. Decided by the receiving task, which owns
+// old_name; packets queued to stage 2 carry the answer (vban_stage_packet_t.old_stream).
+static inline bool vban_crossfade_is_old(vban_handle_t handle, const vban_header_t* header) {
+  const char* old_name = handle->ctx.receiver.crossfade.old_name;
+  return old_name[0] && strncmp(header->stream_name, old_name, VBAN_STREAM_NAME_MAX_LEN) == 0;
+}
+
+// Deliver audio packets of one stream in order: pull ring, then application callbacks, which only see the stream that
+// was switched to.
+static HOT_PATH_ATTR void vban_receiver_deliver_now(vban_handle_t handle, const vban_packet_desc_t* packets, size_t num_packets,
+                                                    bool old_stream) {
+  if (handle->ctx.receiver.config.pull_enabled) {
+    vban_receiver_pull_feed(handle, packets, num_packets, old_stream);
+  }
+  if (!old_stream) {
+    vban_receiver_dispatch(handle, packets, num_packets);
+  }
+}
+
+// Move a received packet's buffer out of its receive slot (to a stage that holds it), refilling the slot from the pool.
+static HOT_PATH_ATTR bool vban_slot_take(packet_pool_t* pool, uint8_t** slots, size_t num_slots, const vban_packet_desc_t* desc) {
+  for (size_t i = 0; i < num_slots; i++) {
+    if (slots[i] == (const uint8_t*)desc->header) {
+      uint8_t* replacement = (uint8_t*)packet_pool_alloc(pool);
+      if (!replacement) {
+        return false;
+      }
+      slots[i] = replacement;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Queue packets to stage 2; the queue owns their buffers until stage 2 has delivered them. A packet still in its
+// receive slot moves to the queue with its buffer (the slot is refilled from the pool), so the payload is not
+// copied between the stages. Packets held by FEC or failover stay with them and are copied into a pool buffer.
+// Each packet is queued with the stream it belongs to, as stage 2 must not read old_name.
+static HOT_PATH_ATTR void vban_stage_push(vban_handle_t handle, const vban_packet_desc_t* packets, size_t num_packets) {
+  vban_stage_rx_t* stage = &handle->ctx.receiver.stage;
+  for (size_t i = 0; i < num_packets; i++) {
+    vban_stage_packet_t staged = {.desc = packets[i], .old_stream = vban_crossfade_is_old(handle, packets[i].header)};
+    uint8_t* buffer = (uint8_t*)packets[i].header;
+    if (!vban_slot_take(handle->pool, handle->ctx.receiver.rx_slots, handle->ctx.receiver.max_batch_packets, &staged.desc)) {
+      buffer = (uint8_t*)packet_pool_alloc(handle->pool);
+      if (!buffer) {
+        handle->ctx.receiver.stats.stage_drops++;
+        continue;
+      }
+      memcpy(buffer, packets[i].header, VBAN_HEADER_SIZE);
+      dma_copy(buffer + VBAN_HEADER_SIZE, packets[i].audio_data, packets[i].audio_data_len);
+      staged.desc.header = (const vban_header_t*)buffer;
+      staged.desc.audio_data = buffer + VBAN_HEADER_SIZE;
+    }
+    if (!spsc_queue_push(&stage->queue, &staged)) {
+      packet_pool_free(handle->pool, buffer);
+      handle->ctx.receiver.stats.stage_drops++;
+      continue;
+    }
+    stage->pushed = true;
+  }
+}
+
+// Deliver audio packets, or hand them to stage 2 on a staged receiver. Delivered in runs of packets of the same
+// stream (one run per batch outside of a switch).
+static HOT_PATH_ATTR void vban_receiver_deliver(vban_handle_t handle, const vban_packet_desc_t* packets, size_t num_packets) {
+  if (handle->ctx.receiver.stage.running) {
+    vban_stage_push(handle, packets, num_packets);
+    return;
+  }
+  size_t run = 0;
+  bool run_old = num_packets > 0 && vban_crossfade_is_old(handle, packets[0].header);
+  for (size_t i = 1; i <= num_packets; i++) {
+    const bool old_stream = i < num_packets && vban_crossfade_is_old(handle, packets[i].header);
+    if (i == num_packets || old_stream != run_old) {
+      vban_receiver_deliver_now(handle, &packets[run], i - run, run_old);
+      run = i;
+      run_old = old_stream;
+    }
+  }
+}
+
+// --- Receiver FEC ---
+
+// Rebuild the single missing packet of the current group from the parity and the other packets.
+static HOT_PATH_ATTR void vban_fec_recover(vban_handle_t handle) {
+  vban_fec_rx_t* fec = &handle->ctx.receiver.fec;
+  const uint32_t group_size = handle->ctx.receiver.config.fec_group_size;
+  const uint32_t missing_index = __builtin_ctz(~fec->held_mask & ((1u << group_size) - 1));
+
+  const uint8_t* prefix = fec->parity.audio_data;
+  const size_t max_len = fec->parity.audio_data_len - VBAN_FEC_PARITY_PREFIX_SIZE;
+  uint32_t format_word;
+  uint16_t length;
+  memcpy(&format_word, prefix, sizeof(format_word));
+  memcpy(&length, prefix + 4, sizeof(length));
+
+  uint8_t* buffer = (uint8_t*)packet_pool_alloc(handle->pool);
+  if (!buffer || max_len > VBAN_MAX_PAYLOAD_SIZE) {
+    packet_pool_free(handle->pool, buffer);
+    return;
+  }
+  uint8_t* payload = buffer + VBAN_HEADER_SIZE;
+  memcpy(payload, prefix + VBAN_FEC_PARITY_PREFIX_SIZE, max_len);
+
+  const vban_header_t* reference = NULL;
+  for (uint32_t i = 0; i < group_size; i++) {
+    if (!(fec->held_mask & (1u << i))) {
+      continue;
+    }
+    const vban_packet_desc_t* held = &fec->held[i];
+    uint32_t word;
+    memcpy(&word, &held->header->sr_subprotocol, sizeof(word));
+    format_word ^= word;
+    length ^= (uint16_t)held->audio_data_len;
+    vban_xor_bytes(payload, held->audio_data, held->audio_data_len < max_len ? held->audio_data_len : max_len);
+    reference = held->header;
+  }
+  if (!reference || length > max_len) {
+    ESP_LOGD(TAG, "FEC: Inconsistent parity for group %u", (unsigned)fec->base);
+    packet_pool_free(handle->pool, buffer);
+    return;
+  }
+
+  vban_header_t* header = (vban_header_t*)buffer;
+  header->vban_magic = VBAN_MAGIC_NUMBER;
+  memcpy(&header->sr_subprotocol, &format_word, sizeof(format_word));
+  memcpy(header->stream_name, reference->stream_name, VBAN_STREAM_NAME_MAX_LEN);
+  header->frame_counter = fec->base + missing_index;
+
+  vban_packet_desc_t* desc = &fec->held[missing_index];
+  *desc = fec->parity;
+  desc->header = header;
+  desc->audio_data = payload;
+  desc->audio_data_len = length;
+  fec->held_mask |= 1u << missing_index;
+  handle->ctx.receiver.stats.fec_recovered++;
+}
+
+// Deliver the held packets of the current group in frame order and return their buffers to the pool.
+static HOT_PATH_ATTR void vban_fec_flush(vban_handle_t handle) {
+  vban_fec_rx_t* fec = &handle->ctx.receiver.fec;
+  const uint32_t group_size = handle->ctx.receiver.config.fec_group_size;
+  vban_packet_desc_t* packets = fec->ordered;
+  size_t num_packets = 0;
+
+  for (uint32_t i = 0; i < group_size; i++) {
+    if (fec->held_mask & (1u << i)) {
+      packets[num_packets++] = fec->held[i];
+    }
+  }
+  if (num_packets < group_size) {
+    handle->ctx.receiver.stats.fec_unrecoverable += group_size - num_packets;
+    ESP_LOGD(TAG, "FEC: %d packets of group %u lost", (int)(group_size - num_packets), (unsigned)fec->base);
+  }
+  if (num_packets > 0) {
+    vban_receiver_deliver(handle, packets, num_packets);
+  }
+
+  for (size_t i = 0; i < num_packets; i++) {
+    packet_pool_free(handle->pool, (void*)packets[i].header);
+  }
+  packet_pool_free(handle->pool, (void*)fec->parity.header);
+  fec->parity.header = NULL;
+  fec->held_mask = 0;
+  fec->open = false;
+}
+
+// Deliver the partial group still being collected when the receiver stops being served, instead of dropping it, and
+// forget the group base so that the next run learns it afresh (the sender may have restarted its counter meanwhile).
+static void vban_fec_finish(vban_handle_t handle) {
+  vban_fec_rx_t* fec = &handle->ctx.receiver.fec;
+  if (fec->open) {
+    vban_fec_flush(handle);
+  }
+  fec->started = false;
+}
+
+// Add one accepted packet (audio or parity) to its group. Groups are delivered once complete or repaired,
+// or when a later group starts; packets of a group that was already delivered are dropped to keep the order.
+static HOT_PATH_ATTR void vban_fec_process(vban_handle_t handle, uint8_t** slots, size_t num_slots, const vban_packet_desc_t* desc) {
+  vban_fec_rx_t* fec = &handle->ctx.receiver.fec;
+  const uint32_t group_size = handle->ctx.receiver.config.fec_group_size;
+  const bool is_parity = (desc->header->sr_subprotocol & VBAN_SUBPROTOCOL_MASK) == VBAN_SUBPROTOCOL_USER;
+  const uint32_t frame_counter = desc->header->frame_counter;
+
+  if (is_parity && desc->header->samples_per_frame_m1 + 1u != group_size) {
+    ESP_LOGD(TAG, "FEC: Parity for %d packets, expected %d", desc->header->samples_per_frame_m1 + 1, (int)group_size);
+    return;
+  }
+  // The sender numbers a parity packet with the first counter of its group: an off-grid one would misplace the groups
+  if (is_parity && (frame_counter & (group_size - 1u)) != 0) {
+    ESP_LOGD(TAG, "FEC: Parity %u not aligned to a group of %d", (unsigned)frame_counter, (int)group_size);
+    return;
+  }
+  // Power of two group sizes divide the counter range, so groups stay aligned when frame_counter wraps
+  const uint32_t base = frame_counter & ~(group_size - 1u);
+
+  if (fec->started) {
+    int32_t distance = (int32_t)(base - fec->base);
+    if (distance < 0 || (distance == 0 && !fec->open)) {
+      ESP_LOGD(TAG, "FEC: Late packet %u dropped", (unsigned)frame_counter);
+      return;
+    }
+    if (distance > 0 && fec->open) {
+      vban_fec_flush(handle);
+    }
+    if ((uint32_t)distance > group_size) {  // Whole groups between the last one and this one were lost
+      handle->ctx.receiver.stats.fec_unrecoverable += ((uint32_t)distance / group_size - 1) * group_size;
+    }
+  }
+  if (!fec->open) {
+    fec->base = base;
+    fec->started = true;
+    fec->open = true;
+  }
+
+  if (is_parity) {
+    if (fec->parity.header || !vban_slot_take(handle->pool, slots, num_slots, desc)) {
+      return;
+    }
+    fec->parity = *desc;
+  } else {
+    const uint32_t bit = 1u << (frame_counter - base);
+    if ((fec->held_mask & bit) || !vban_slot_take(handle->pool, slots, num_slots, desc)) {
+      return;  // Duplicate, or the pool is exhausted (the reservation covers a full group)
+    }
+    fec->held[frame_counter - base] = *desc;
+    fec->held_mask |= bit;
+  }
+
+  const uint32_t full_mask = (1u << group_size) - 1;
+  if (fec->held_mask != full_mask && fec->parity.header && __builtin_popcount(fec->held_mask) == (int)group_size - 1) {
+    vban_fec_recover(handle);
+  }
+  if (fec->held_mask == full_mask) {
+    vban_fec_flush(handle);
+  }
+}
+
+// --- Receiver Failover ---
+
+// Hash of a payload for content alignment. All-zero payloads (digital silence) cannot be aligned and yield 0.
+static HOT_PATH_ATTR uint32_t vban_failover_hash(const uint8_t* data, size_t len) {
+  uint32_t hash = 2166136261u;  // FNV-1a, a word at a time
+  uint32_t bits = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t)) {
+    uint32_t word;
+    memcpy(&word, data + i, sizeof(word));
+    bits |= word;
+    hash = (hash ^ word) * 16777619u;
+  }
+  for (; i < len; i++) {
+    bits |= data[i];
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  if (!bits) {
+    return 0;
+  }
+  return hash ? hash : 1;
+}
+
+// Align the streams by content: remember the packet's hash and look for the same audio in the other stream.
+static HOT_PATH_ATTR void vban_failover_learn_offset(vban_failover_rx_t* failover, bool is_backup, const vban_packet_desc_t* desc) {
+  uint32_t hash = vban_failover_hash(desc->audio_data, desc->audio_data_len);
+  if (hash == 0) {
+    return;
+  }
+  const int self = is_backup ? 1 : 0;
+  failover->history[self][failover->history_pos[self]].frame_counter = desc->header->frame_counter;
+  failover->history[self][failover->history_pos[self]].hash = hash;
+  failover->history_pos[self] = (failover->history_pos[self] + 1) % VBAN_FAILOVER_HISTORY;
+
+  for (size_t i = 0; i < VBAN_FAILOVER_HISTORY; i++) {
+    if (failover->history[!self][i].hash != hash) {
+      continue;
+    }
+    uint32_t primary_frame = is_backup ? failover->history[0][i].frame_counter : desc->header->frame_counter;
+    uint32_t backup_frame = is_backup ? desc->header->frame_counter : failover->history[1][i].frame_counter;
+    failover->offset = backup_frame - primary_frame;
+    failover->offset_valid = true;
+    memset(failover->history, 0, sizeof(failover->history));
+    ESP_LOGI(TAG, "Failover: Streams aligned, backup frame offset %d", (int)failover->offset);
+    return;
+  }
+}
+
+// frame_counter of a standby packet expressed in the active stream's frame_counter
+static inline uint32_t vban_failover_to_active(const vban_failover_rx_t* failover, uint32_t standby_frame) {
+  return failover->backup_active ? standby_frame + failover->offset : standby_frame - failover->offset;
+}
+
+static HOT_PATH_ATTR void vban_failover_release(packet_pool_t* pool, vban_packet_desc_t* held) {
+  packet_pool_free(pool, (void*)held->header);
+  held->header = NULL;
+}
+
+// Keep a standby packet, evicting the oldest one if the hold is full
+static HOT_PATH_ATTR void vban_failover_hold(vban_handle_t handle, uint8_t** slots, size_t num_slots, const vban_packet_desc_t* desc) {
+  vban_failover_rx_t* failover = &handle->ctx.receiver.failover;
+  vban_packet_desc_t* entry = NULL;
+  for (size_t i = 0; i < VBAN_FAILOVER_HOLD_PACKETS; i++) {
+    vban_packet_desc_t* held = &failover->hold[i];
+    if (!held->header) {
+      entry = held;
+      break;
+    }
+    if (!entry || held->arrival_time_us < entry->arrival_time_us) {
+      entry = held;
+    }
+  }
+  if (entry->header) {
+    vban_failover_release(handle->pool, entry);
+  }
+  if (vban_slot_take(handle->pool, slots, num_slots, desc)) {
+    *entry = *desc;
+  }
+}
+
+// Make the standby stream the active one and play what it already delivered, in order
+static HOT_PATH_ATTR void vban_failover_switch(vban_handle_t handle, int64_t now_us) {
+  vban_failover_rx_t* failover = &handle->ctx.receiver.failover;
+  const bool to_backup = !failover->backup_active;
+
+  // The play position moves to the new stream's frame_counter; without alignment, play starts at its oldest packet
+  if (failover->offset_valid && failover->synced) {
+    failover->next = to_backup ? failover->next + failover->offset : failover->next - failover->offset;
+  } else {
+    bool found = false;
+    for (size_t i = 0; i < VBAN_FAILOVER_HOLD_PACKETS; i++) {
+      const vban_packet_desc_t* held = &failover->hold[i];
+      if (held->header && (!found || (int32_t)(held->header->frame_counter - failover->next) < 0)) {
+        failover->next = held->header->frame_counter;
+        found = true;
+      }
+    }
+    failover->synced = failover->synced || found;
+  }
+  failover->backup_active = to_backup;
+
+  vban_failover_event_t* event = &failover->events[failover->num_events % VBAN_FAILOVER_EVENT_LOG_SIZE];
+  event->time_us = now_us;
+  event->outage_us = (uint32_t)(now_us - failover->last_active_us);
+  event->frame_counter = failover->next;
+  event->to_backup = to_backup;
+  failover->num_events++;
+  handle->ctx.receiver.stats.failovers++;
+  failover->last_active_us = now_us;
+  failover->standby_streak = 0;
+  ESP_LOGW(TAG, "Failover: Switched to the %s stream at frame %u after %u us", to_backup ? "backup" : "primary",
+           (unsigned)failover->next, (unsigned)event->outage_us);
+
+  // Held packets now belong to the active stream: play those at or after the play position in frame order
+  while (true) {
+    vban_packet_desc_t* first = NULL;
+    for (size_t i = 0; i < VBAN_FAILOVER_HOLD_PACKETS; i++) {
+      vban_packet_desc_t* held = &failover->hold[i];
+      if (!held->header) {
+        continue;
+      }
+      if ((int32_t)(held->header->frame_counter - failover->next) < 0) {
+        vban_failover_release(handle->pool, held);  // Already played from the other stream
+      } else if (!first || (int32_t)(held->header->frame_counter - first->header->frame_counter) < 0) {
+        first = held;
+      }
+    }
+    if (!first) {
+      break;
+    }
+    vban_receiver_deliver(handle, first, 1);
+    failover->next = first->header->frame_counter + 1;
+    vban_failover_release(handle->pool, first);
+  }
+}
+
+// Route one accepted packet of the primary or backup stream. Packets of the active stream are played at once;
+// a loss of the active stream is filled from the held standby packets when the next active packet arrives.
+static HOT_PATH_ATTR void vban_failover_process(vban_handle_t handle, uint8_t** slots, size_t num_slots, const vban_packet_desc_t* desc) {
+  vban_failover_rx_t* failover = &handle->ctx.receiver.failover;
+  const uint32_t timeout_ms = handle->ctx.receiver.config.failover_timeout_ms;
+  const int64_t timeout_us = (int64_t)(timeout_ms > 0 ? timeout_ms : VBAN_DEFAULT_FAILOVER_TIMEOUT_MS) * 1000;
+  const bool is_backup = strncmp(desc->header->stream_name, failover->backup_name, VBAN_STREAM_NAME_MAX_LEN) == 0;
+  const uint32_t frame = desc->header->frame_counter;
+  const int64_t now_us = desc->arrival_time_us;
+
+  if (!failover->synced && failover->last_active_us == 0) {
+    failover->last_active_us = now_us;  // Give the primary one timeout to show up
+  }
+  if (!failover->offset_valid) {
+    vban_failover_learn_offset(failover, is_backup, desc);
+  }
+
+  if (is_backup == failover->backup_active) {
+    if (!failover->synced) {
+      failover->next = frame;
+      failover->synced = true;
+    }
+    int32_t distance = (int32_t)(frame - failover->next);
+    if (distance <= -VBAN_FAILOVER_RESYNC_DISTANCE || distance >= VBAN_FAILOVER_RESYNC_DISTANCE) {
+      // The active sender restarted: follow it and align the streams again
+      ESP_LOGI(TAG, "Failover: Active stream jumped from frame %u to %u", (unsigned)failover->next, (unsigned)frame);
+      failover->next = frame;
+      failover->offset_valid = false;
+    } else if (distance < 0) {
+      ESP_LOGD(TAG, "Failover: Late packet %u dropped", (unsigned)frame);
+      return;
+    }
+
+    if (failover->offset_valid) {
+      for (; failover->next != frame; failover->next++) {
+        for (size_t i = 0; i < VBAN_FAILOVER_HOLD_PACKETS; i++) {
+          vban_packet_desc_t* held = &failover->hold[i];
+          if (held->header && vban_failover_to_active(failover, held->header->frame_counter) == failover->next) {
+            vban_receiver_deliver(handle, held, 1);
+            vban_failover_release(handle->pool, held);
+            handle->ctx.receiver.stats.failover_gap_fills++;
+            break;
+          }
+        }
+      }
+      for (size_t i = 0; i < VBAN_FAILOVER_HOLD_PACKETS; i++) {
+        vban_packet_desc_t* held = &failover->hold[i];
+        if (held->header && (int32_t)(vban_failover_to_active(failover, held->header->frame_counter) - frame) <= 0) {
+          vban_failover_release(handle->pool, held);
+        }
+      }
+    }
+    vban_receiver_deliver(handle, desc, 1);
+    failover->next = frame + 1;
+    failover->last_active_us = now_us;
+    return;
+  }
+
+  // Standby packet
+  failover->standby_streak = (frame == failover->standby_last + 1) ? failover->standby_streak + 1 : 0;
+  failover->standby_last = frame;
+
+  bool already_played = false;
+  if (failover->offset_valid && failover->synced) {
+    int32_t distance = (int32_t)(vban_failover_to_active(failover, frame) - failover->next);
+    if (distance <= -VBAN_FAILOVER_RESYNC_DISTANCE || distance >= VBAN_FAILOVER_RESYNC_DISTANCE) {
+      failover->offset_valid = false;  // The standby sender restarted
+    } else {
+      already_played = distance < 0;
+    }
+  }
+  if (!already_played) {
+    vban_failover_hold(handle, slots, num_slots, desc);
+  }
+
+  // Switch when the active stream went silent, or back to the primary once it is steady again
+  if (now_us - failover->last_active_us > timeout_us) {
+    vban_failover_switch(handle, now_us);
+  } else if (failover->backup_active && failover->offset_valid && failover->standby_streak >= VBAN_FAILOVER_REVERT_PACKETS) {
+    vban_failover_switch(handle, now_us);
+  }
+}
+
+// Add the cycles of a batch to a 64-bit sum and its maximum under a sequence counter (as level_meter_add() does):
+// on this 32-bit CPU the sum takes two stores, and vban_receiver_get_stats() retries instead of reading half of one.
+static inline void vban_stats_add_cycles(atomic_uint* seq, uint64_t* sum, uint32_t* max, uint32_t cycles) {
+  const unsigned count = atomic_load_explicit(seq, memory_order_relaxed);  // Only the writing task changes seq
+  atomic_store_explicit(seq, count + 1, memory_order_relaxed);              // Odd: readers retry
+  atomic_thread_fence(memory_order_release);
+  *sum += cycles;
+  if (cycles > *max) {
+    *max = cycles;
+  }
+  atomic_store_explicit(seq, count + 2, memory_order_release);
+}
+
+// Read a sum and maximum written by vban_stats_add_cycles(), from any task
+static void vban_stats_read_cycles(atomic_uint* seq, const uint64_t* sum, const uint32_t* max, uint64_t* sum_out, uint32_t* max_out) {
+  unsigned begin, end;
+  do {
+    begin = atomic_load_explicit(seq, memory_order_acquire);
+    *sum_out = *(const volatile uint64_t*)sum;
+    *max_out = *(const volatile uint32_t*)max;
+    atomic_thread_fence(memory_order_acquire);  // The copy is complete before seq is checked again
+    end = atomic_load_explicit(seq, memory_order_relaxed);
+  } while (begin != end || (begin & 1u));
+}
+
+// Per-handle processing of a drained batch. With FEC, packets are held per group (their buffers leave the
+// receive slots) and delivered in frame order once the group is complete or repaired. With a backup stream,
+// packets go through the failover stage.
+static HOT_PATH_ATTR void vban_receiver_process_batch(vban_handle_t handle, uint8_t** slots, size_t num_slots,
+                                                      const vban_packet_desc_t* packets, size_t num_packets) {
+  const esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+  if (handle->ctx.receiver.config.fec_group_size > 0) {
+    for (size_t i = 0; i < num_packets; i++) {
+      vban_fec_process(handle, slots, num_slots, &packets[i]);
+    }
+  } else if (handle->ctx.receiver.config.backup_stream_name[0]) {
+    for (size_t i = 0; i < num_packets; i++) {
+      vban_failover_process(handle, slots, num_slots, &packets[i]);
+    }
+  } else {
+    vban_receiver_deliver(handle, packets, num_packets);
+    if (!handle->ctx.receiver.crossfade.active) {
+      // The name filter now rejects the old stream, and its packets already queued to stage 2 carry their flag
+      handle->ctx.receiver.crossfade.old_name[0] = '\0';
+    }
+  }
+  if (handle->ctx.receiver.stage.pushed) {
+    handle->ctx.receiver.stage.pushed = false;
+    xSemaphoreGive(handle->ctx.receiver.stage.ready);  // One wakeup of stage 2 per batch
+  }
+
+  const uint32_t cycles = (uint32_t)(esp_cpu_get_cycle_count() - start);  // Wraps safely (batches are far shorter)
+  vban_stats_add_cycles(&handle->ctx.receiver.stats_seq, &handle->ctx.receiver.stats.process_cycles,
+                        &handle->ctx.receiver.stats.process_cycles_max, cycles);
+}
+
+static void vban_receive_task(void* pvParameters) {
+  vban_handle_t handle = (vban_handle_t)pvParameters;
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    ESP_LOGE(TAG, "Receive task: Invalid handle passed");
+    vTaskDelete(NULL);
+    return;
+  }
+
+  ESP_LOGI(TAG, "VBAN Receiver task started for stream '%s' on port %d",
+           handle->ctx.receiver.config.expected_stream_name[0] ? handle->ctx.receiver.config.expected_stream_name : "<ANY>",
+           handle->ctx.receiver.config.listen_port);
+
+  alloc_guard_watch_task(NULL);  // Steady state: everything this task touches was allocated at setup
+
+  while (handle->ctx.receiver.state == VBAN_RECEIVER_STATE_RUNNING) {
+    // Block for the first packet of a burst, then drain whatever else is already queued on the socket
+    // without blocking, so a burst is dispatched in one go.
+    size_t num_packets = vban_receiver_drain(handle, handle->ctx.receiver.rx_slots, handle->ctx.receiver.batch_packets,
+                                             handle->ctx.receiver.max_batch_packets, true);
+
+    if (num_packets > 0 && handle->ctx.receiver.state == VBAN_RECEIVER_STATE_RUNNING) {
+      vban_receiver_process_batch(handle, handle->ctx.receiver.rx_slots, handle->ctx.receiver.max_batch_packets,
+                                  handle->ctx.receiver.batch_packets, num_packets);
+    }
+  }
+
+  ESP_LOGI(TAG, "VBAN Receiver task for stream '%s' stopping.",
+           handle->ctx.receiver.config.expected_stream_name[0] ? handle->ctx.receiver.config.expected_stream_name : "<ANY>");
+  if (handle->ctx.receiver.config.fec_group_size > 0) {
+    vban_fec_finish(handle);  // Queued to stage 2 before it is told to stop
+  }
+  if (handle->ctx.receiver.stage.running) {
+    handle->ctx.receiver.stage.pushed = false;
+    handle->ctx.receiver.stage.running = false;  // Stage 2 delivers what is queued, then parks
+    xSemaphoreGive(handle->ctx.receiver.stage.ready);
+  }
+  alloc_guard_unwatch_task(NULL);
+  handle->ctx.receiver.receive_task_handle = NULL;  // Clear task handle as it's about to park
+  handle->ctx.receiver.state = VBAN_RECEIVER_STATE_IDLE;
+  vTaskSuspend(NULL);  // Park; deleted by vban_task_reap() so that its static memory can be reused
+}
+
+// Stage 2 of a staged receiver: deliver the packets queued by the receive task, then return their buffers.
+static void vban_stage2_task(void* pvParameters) {
+  vban_handle_t handle = (vban_handle_t)pvParameters;
+  vban_stage_rx_t* stage = &handle->ctx.receiver.stage;
+  alloc_guard_watch_task(NULL);
+
+  bool running = true;
+  while (running) {
+    xSemaphoreTake(stage->ready, portMAX_DELAY);
+    running = stage->running;  // Read before draining, so nothing queued before the stop is left behind
+
+    size_t num_packets = 0;
+    do {
+      num_packets = 0;
+      vban_stage_packet_t staged;
+      while (num_packets < handle->ctx.receiver.max_batch_packets && spsc_queue_pop(&stage->queue, &staged)) {
+        stage->batch[num_packets] = staged.desc;
+        stage->batch_old[num_packets] = staged.old_stream;
+        num_packets++;
+      }
+      if (num_packets == 0) {
+        break;
+      }
+
+      const esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+      size_t run = 0;  // Delivered in runs of packets of the same stream, as stage 1 tagged them
+      for (size_t i = 1; i <= num_packets; i++) {
+        if (i == num_packets || stage->batch_old[i] != stage->batch_old[run]) {
+          vban_receiver_deliver_now(handle, &stage->batch[run], i - run, stage->batch_old[run]);
+          run = i;
+        }
+      }
+      const uint32_t cycles = (uint32_t)(esp_cpu_get_cycle_count() - start);
+      vban_deliver_stats_t* deliver_stats = &handle->ctx.receiver.deliver_stats;
+      vban_stats_add_cycles(&deliver_stats->seq, &deliver_stats->cycles, &deliver_stats->cycles_max, cycles);
+
+      for (size_t i = 0; i < num_packets; i++) {
+        packet_pool_free(handle->pool, (void*)stage->batch[i].header);
+      }
+    } while (num_packets == handle->ctx.receiver.max_batch_packets);
+  }
+
+  alloc_guard_unwatch_task(NULL);
+  vTaskSuspend(NULL);  // Park; deleted by vban_task_reap()
+}
+
+// Release everything owned by a receiver handle, including the handle itself. Safe on partially created handles.
+// Its tasks must have been reaped (see vban_receiver_delete()); a handle that failed creation has none.
+static void vban_receiver_free(vban_handle_t handle) {
+  if (handle->ctx.receiver.task_stack_owned) {
+    heap_caps_free(handle->ctx.receiver.task_stack);
+  }
+  vban_stage_rx_t* stage = &handle->ctx.receiver.stage;
+  if (stage->task_stack_owned) {
+    heap_caps_free(stage->task_stack);
+  }
+  if (stage->queue.items) {
+    vban_stage_packet_t staged;
+    while (spsc_queue_pop(&stage->queue, &staged)) {  // Left behind if stage 2 never ran
+      packet_pool_free(handle->pool, (void*)staged.desc.header);
+    }
+  }
+  vban_mem_free(handle->arena, stage->queue.items);
+  vban_mem_free(handle->arena, stage->batch);
+  vban_mem_free(handle->arena, stage->batch_old);
+  if (stage->ready) vSemaphoreDelete(stage->ready);
+  if (handle->sock_fd >= 0) {
+    close(handle->sock_fd);
+    handle->sock_fd = -1;
+  }
+  circular_buffer_destroy(&handle->ctx.receiver.pull_ring);
+  heap_caps_free(handle->ctx.receiver.pull_ring_storage);
+  circular_buffer_destroy(&handle->ctx.receiver.crossfade.stage_old);
+  circular_buffer_destroy(&handle->ctx.receiver.crossfade.stage_new);
+  if (handle->ctx.receiver.pull_mutex) vSemaphoreDelete(handle->ctx.receiver.pull_mutex);
+  if (handle->ctx.receiver.pull_data_ready) vSemaphoreDelete(handle->ctx.receiver.pull_data_ready);
+  vban_slots_free(handle->arena, handle->pool, handle->ctx.receiver.rx_slots, handle->ctx.receiver.max_batch_packets);
+  vban_mem_free(handle->arena, handle->ctx.receiver.batch_packets);
+  for (uint32_t i = 0; i < VBAN_FEC_MAX_GROUP_SIZE; i++) {
+    if (handle->ctx.receiver.fec.held_mask & (1u << i)) {
+      packet_pool_free(handle->pool, (void*)handle->ctx.receiver.fec.held[i].header);
+    }
+  }
+  packet_pool_free(handle->pool, (void*)handle->ctx.receiver.fec.parity.header);
+  for (size_t i = 0; i < VBAN_FAILOVER_HOLD_PACKETS; i++) {
+    packet_pool_free(handle->pool, (void*)handle->ctx.receiver.failover.hold[i].header);
+  }
+  if (handle->pool_reserved > 0) {
+    packet_pool_unreserve(handle->pool, handle->pool_reserved);
+  }
+  vban_handle_free(handle);
+}
+
+vban_handle_t vban_receiver_create(const vban_receiver_config_t* config) {
+  if (!config || (!config->audio_callback && !config->audio_batch_callback && !config->pull_enabled)) {
+    ESP_LOGE(TAG, "Receiver create: Invalid arguments (callback missing)");
+    return NULL;
+  }
+  if (config->pull_enabled &&
+      (!pcm_convert_is_output_supported(config->pull_format.data_type) || config->pull_format.num_channels == 0 ||
+       vban_get_sr_from_index(config->pull_format.sample_rate_idx) == 0)) {
+    ESP_LOGE(TAG, "Receiver create: Invalid pull format");
+    return NULL;
+  }
+  if ((config->metering_enabled || config->silence_gate_ms > 0) && !config->pull_enabled) {
+    ESP_LOGE(TAG, "Receiver create: Metering and the silence gate need the pull interface");
+    return NULL;
+  }
+  if (strlen(config->expected_stream_name) >= VBAN_STREAM_NAME_MAX_LEN) {
+    ESP_LOGE(TAG, "Receiver create: Expected stream name too long");
+    return NULL;
+  }
+  if (config->fec_group_size > 0 && (!vban_fec_group_size_valid(config->fec_group_size) || !config->expected_stream_name[0])) {
+    ESP_LOGE(TAG, "Receiver create: FEC needs a power of two group size from 2 to %d and an expected stream name",
+             VBAN_FEC_MAX_GROUP_SIZE);
+    return NULL;
+  }
+  if (config->backup_stream_name[0] &&
+      (strnlen(config->backup_stream_name, VBAN_STREAM_NAME_MAX_LEN) >= VBAN_STREAM_NAME_MAX_LEN || !config->expected_stream_name[0] ||
+       strcmp(config->backup_stream_name, config->expected_stream_name) == 0 || config->fec_group_size > 0)) {
+    ESP_LOGE(TAG, "Receiver create: Backup stream needs a distinct expected stream name and no FEC");
+    return NULL;
+  }
+
+  dma_copy_init();  // At setup time, as the driver allocates (copies stay on the CPU if it is unavailable)
+  vban_handle_t handle = (vban_handle_t)vban_mem_alloc(config->arena, sizeof(struct vban_instance_s));
+  if (!handle) {
+    ESP_LOGE(TAG, "Receiver create: No memory for handle");
+    return NULL;
+  }
+
+  handle->type = VBAN_INSTANCE_TYPE_RECEIVER;
+  handle->sock_fd = -1;
+  vban_handle_init(handle, config->arena);
+  memcpy(&handle->ctx.receiver.config, config, sizeof(vban_receiver_config_t));
+  handle->ctx.receiver.state = VBAN_RECEIVER_STATE_IDLE;
+  handle->ctx.receiver.receive_task_handle = NULL;
+  handle->ctx.receiver.max_batch_packets = config->max_batch_packets > 0 ? config->max_batch_packets : VBAN_DEFAULT_BATCH_PACKETS;
+  portMUX_INITIALIZE(&handle->ctx.receiver.crossfade.request_lock);
+  portMUX_INITIALIZE(&handle->ctx.receiver.discovery.lock);
+  handle->ctx.receiver.fast_payload_size = SIZE_MAX;  // A zero format word with an empty payload must not match
+  vban_receiver_update_follows_fixed(handle);
+
+  if (config->fec_group_size > 0) {
+    // A group holds at most every packet but one plus the parity, or every packet
+    if (vban_pool_reserve(handle, config->fec_group_size + 1) != ESP_OK) {
+      ESP_LOGE(TAG, "Receiver create: No memory for FEC group buffers");
+      vban_receiver_free(handle);
+      return NULL;
+    }
+    vban_fec_get_stream_name(config->expected_stream_name, handle->ctx.receiver.fec.stream_name);
+  }
+  if (config->backup_stream_name[0]) {
+    if (vban_pool_reserve(handle, VBAN_FAILOVER_HOLD_PACKETS) != ESP_OK) {
+      ESP_LOGE(TAG, "Receiver create: No memory for failover buffers");
+      vban_receiver_free(handle);
+      return NULL;
+    }
+    strncpy(handle->ctx.receiver.failover.backup_name, config->backup_stream_name, VBAN_STREAM_NAME_MAX_LEN);
+  }
+
+  if (config->staged) {
+    vban_stage_rx_t* stage = &handle->ctx.receiver.stage;
+    size_t depth = config->stage2_queue_packets > 0 ? config->stage2_queue_packets : VBAN_DEFAULT_STAGE_QUEUE_PACKETS;
+    void* storage = vban_mem_alloc(config->arena, depth * sizeof(vban_stage_packet_t));
+    stage->batch = (vban_packet_desc_t*)vban_mem_alloc(config->arena, handle->ctx.receiver.max_batch_packets * sizeof(vban_packet_desc_t));
+    stage->batch_old = (bool*)vban_mem_alloc(config->arena, handle->ctx.receiver.max_batch_packets * sizeof(bool));
+    stage->ready = vban_binary_semaphore_create(config->arena);
+    // Buffers in flight: a full queue plus the batch stage 2 is delivering
+    if (!storage || spsc_queue_init(&stage->queue, storage, sizeof(vban_stage_packet_t), depth) != ESP_OK || !stage->batch ||
+        !stage->batch_old || !stage->ready || vban_pool_reserve(handle, depth + handle->ctx.receiver.max_batch_packets) != ESP_OK) {
+      ESP_LOGE(TAG, "Receiver create: No memory for a stage queue of %d packets (a power of two)", (int)depth);
+      if (!stage->queue.items) {
+        vban_mem_free(config->arena, storage);
+      }
+      vban_receiver_free(handle);
+      return NULL;
+    }
+  }
+
+  if (config->pull_enabled) {
+    size_t pull_frames = config->pull_buffer_frames > 0 ? config->pull_buffer_frames : VBAN_DEFAULT_PULL_BUFFER_FRAMES;
+    handle->ctx.receiver.pull_frame_bytes = config->pull_format.num_channels * vban_get_data_type_size(config->pull_format.data_type);
+    handle->ctx.receiver.passthrough_word = (uint32_t)(config->pull_format.sample_rate_idx | VBAN_SUBPROTOCOL_AUDIO) |
+                                            ((uint32_t)(config->pull_format.num_channels - 1) << 16) |
+                                            ((uint32_t)(config->pull_format.data_type | VBAN_CODEC_PCM) << 24);
+    handle->ctx.receiver.pull_mutex = vban_mutex_create(config->arena);
+    handle->ctx.receiver.pull_data_ready = vban_binary_semaphore_create(config->arena);
+    if (!vban_dma_ring_init(&handle->ctx.receiver.pull_ring, pull_frames * handle->ctx.receiver.pull_frame_bytes,
+                            &handle->ctx.receiver.pull_ring_storage) ||
+        !handle->ctx.receiver.pull_mutex || !handle->ctx.receiver.pull_data_ready) {
+      ESP_LOGE(TAG, "Receiver create: No memory for pull ring (%d frames)", (int)pull_frames);
+      vban_receiver_free(handle);
+      return NULL;
+    }
+  }
+  if (config->metering_enabled) {
+    uint32_t window = vban_get_sr_from_index(config->pull_format.sample_rate_idx) / 1000 * VBAN_LEVEL_WINDOW_MS;
+    level_meter_init(&handle->ctx.receiver.meter, window * config->pull_format.num_channels);
+  }
+  if (config->silence_gate_ms > 0) {
+    vban_gate_rx_t* gate = &handle->ctx.receiver.gate;
+    gate->hold_frames = vban_get_sr_from_index(config->pull_format.sample_rate_idx) / 1000 * config->silence_gate_ms;
+    gate->close_level = config->silence_threshold;
+    gate->open_level = config->silence_threshold > UINT16_MAX / 2 ? UINT16_MAX : config->silence_threshold * 2;
+  }
+
+  handle->sock_fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (handle->sock_fd < 0) {
+    ESP_LOGE(TAG, "Receiver create: Failed to create socket: %s", strerror(errno));
+    vban_receiver_free(handle);
+    return NULL;
+  }
+
+  // The receive task blocks in recvfrom(): a timeout lets it re-check its state on a silent port, since lwIP does not
+  // support shutdown() on UDP sockets to wake it
+  struct timeval rx_timeout = {.tv_sec = 0, .tv_usec = VBAN_RECEIVE_TIMEOUT_MS * 1000};
+  if (setsockopt(handle->sock_fd, SOL_SOCKET, SO_RCVTIMEO, &rx_timeout, sizeof(rx_timeout)) < 0) {
+    ESP_LOGE(TAG, "Receiver create: Failed to set receive timeout: %s", strerror(errno));
+    vban_receiver_free(handle);
+    return NULL;
+  }
+
+  struct sockaddr_in server_addr;
+  memset(&server_addr, 0, sizeof(server_addr));
+  server_addr.sin_family = AF_INET;
+  server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  server_addr.sin_port = htons(config->listen_port > 0 ? config->listen_port : VBAN_DEFAULT_PORT);
+
+  if (bind(handle->sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+    ESP_LOGE(TAG, "Receiver create: Failed to bind socket to port %d: %s", ntohs(server_addr.sin_port), strerror(errno));
+    vban_receiver_free(handle);
+    return NULL;
+  }
+
+  ESP_LOGI(TAG, "VBAN Receiver created for stream '%s' on port %d",
+           config->expected_stream_name[0] ? config->expected_stream_name : "<ANY>", ntohs(server_addr.sin_port));
+  return handle;
+}
+
+esp_err_t vban_receiver_delete(vban_handle_t handle) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+
+  if (handle->ctx.receiver.reactor) {
+    vban_reactor_remove_receiver(handle->ctx.receiver.reactor, handle);
+  }
+
+  esp_err_t err = vban_receiver_stop(handle);  // Ensure task is stopped
+  if (err != ESP_OK && err != ESP_ERR_VBAN_NOT_STARTED) {
+    ESP_LOGW(TAG, "Receiver delete: Failed to stop task cleanly, but proceeding with delete.");
+  }
+  // The tasks' control blocks and stacks live in the handle: it is only released once both have parked (the receive
+  // task lets stage 2 finish before it parks)
+  err = vban_task_reap(&handle->ctx.receiver.task);
+  if (err == ESP_OK) {
+    err = vban_task_reap(&handle->ctx.receiver.stage.task);
+  }
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Receiver delete: Task did not stop, receiver not deleted");
+    return err;
+  }
+
+  ESP_LOGI(TAG, "VBAN Receiver for stream '%s' deleted",
+           handle->ctx.receiver.config.expected_stream_name[0] ? handle->ctx.receiver.config.expected_stream_name : "<ANY>");
+  vban_receiver_free(handle);
+  return ESP_OK;
+}
+
+esp_err_t vban_receiver_start(vban_handle_t handle) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (handle->ctx.receiver.state != VBAN_RECEIVER_STATE_IDLE || handle->ctx.receiver.receive_task_handle != NULL) {
+    ESP_LOGW(TAG, "Receiver start: Already started or not idle.");
+    return ESP_ERR_VBAN_ALREADY_STARTED;  // Or ESP_ERR_VBAN_INVALID_STATE
+  }
+  if (handle->ctx.receiver.reactor) {
+    ESP_LOGW(TAG, "Receiver start: Receiver is served by a reactor.");
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+
+  // The stack and packet slots are only needed by the dedicated task (reactor-served receivers share the reactor's)
+  if (!handle->ctx.receiver.task_stack) {
+    const vban_receiver_config_t* cfg = &handle->ctx.receiver.config;
+    handle->ctx.receiver.task_stack_size = cfg->task_stack_size > 0 ? cfg->task_stack_size : VBAN_DEFAULT_TASK_STACK_SIZE;
+    handle->ctx.receiver.task_stack =
+        vban_task_stack_alloc(handle->arena, cfg->task_stack, handle->ctx.receiver.task_stack_size, &handle->ctx.receiver.task_stack_owned);
+    if (!handle->ctx.receiver.task_stack) {
+      ESP_LOGE(TAG, "Receiver start: No memory for a %d-byte task stack", (int)handle->ctx.receiver.task_stack_size);
+      return ESP_ERR_VBAN_NO_MEM;
+    }
+  }
+  if (!handle->ctx.receiver.rx_slots) {
+    if (vban_pool_reserve(handle, handle->ctx.receiver.max_batch_packets) != ESP_OK) {
+      ESP_LOGE(TAG, "Receiver start: No memory for %d packet slots", (int)handle->ctx.receiver.max_batch_packets);
+      return ESP_ERR_VBAN_NO_MEM;
+    }
+    handle->ctx.receiver.rx_slots = vban_slots_alloc(handle->arena, handle->pool, handle->ctx.receiver.max_batch_packets);
+    handle->ctx.receiver.batch_packets =
+        (vban_packet_desc_t*)vban_mem_alloc(handle->arena, handle->ctx.receiver.max_batch_packets * sizeof(vban_packet_desc_t));
+    if (!handle->ctx.receiver.rx_slots || !handle->ctx.receiver.batch_packets) {
+      ESP_LOGE(TAG, "Receiver start: No memory for %d packet slots", (int)handle->ctx.receiver.max_batch_packets);
+      vban_slots_free(handle->arena, handle->pool, handle->ctx.receiver.rx_slots, handle->ctx.receiver.max_batch_packets);
+      vban_mem_free(handle->arena, handle->ctx.receiver.batch_packets);
+      handle->ctx.receiver.rx_slots = NULL;
+      handle->ctx.receiver.batch_packets = NULL;
+      return ESP_ERR_VBAN_NO_MEM;
+    }
+  }
+
+  // The previous task (if any) releases the static memory once reaped
+  esp_err_t err = vban_task_reap(&handle->ctx.receiver.task);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  // Use configured or default task parameters
+  const vban_receiver_config_t* cfg = &handle->ctx.receiver.config;
+  vban_stage_rx_t* stage = &handle->ctx.receiver.stage;
+  if (cfg->staged) {
+    if (!stage->task_stack) {
+      stage->task_stack = vban_task_stack_alloc(handle->arena, NULL, handle->ctx.receiver.task_stack_size, &stage->task_stack_owned);
+      if (!stage->task_stack) {
+        ESP_LOGE(TAG, "Receiver start: No memory for the stage 2 task stack");
+        return ESP_ERR_VBAN_NO_MEM;
+      }
+    }
+    err = vban_task_reap(&stage->task);
+    if (err != ESP_OK) {
+      return err;
+    }
+    stage->running = true;  // Before the receive task starts queueing
+    int priority = cfg->stage2_task_priority > 0 ? cfg->stage2_task_priority
+                                                 : (cfg->task_priority > 0 ? cfg->task_priority : (tskIDLE_PRIORITY + 5));
+    BaseType_t core = cfg->stage2_core_id == 0 || cfg->stage2_core_id == 1 ? cfg->stage2_core_id : tskNO_AFFINITY;
+    stage->task = xTaskCreateStaticPinnedToCore(vban_stage2_task, "vban_stage2", handle->ctx.receiver.task_stack_size, (void*)handle,
+                                                priority, stage->task_stack, &stage->task_tcb, core);
+    if (!stage->task) {
+      stage->running = false;
+      ESP_LOGE(TAG, "Receiver start: Failed to create stage 2 task");
+      return ESP_ERR_VBAN_TASK_CREATE_FAIL;
+    }
+  }
+  // Running from here on, so that a reader pulling right after the start does not take the receiver for stopped
+  handle->ctx.receiver.state = VBAN_RECEIVER_STATE_RUNNING;
+  handle->ctx.receiver.task =
+      xTaskCreateStaticPinnedToCore(vban_receive_task,
+                                    "vban_rx_task",                                                         // Task name
+                                    handle->ctx.receiver.task_stack_size,                                   // Stack size
+                                    (void*)handle,                                                          // Parameter
+                                    cfg->task_priority > 0 ? cfg->task_priority : (tskIDLE_PRIORITY + 5),   // Priority
+                                    handle->ctx.receiver.task_stack,                                        // Stack
+                                    &handle->ctx.receiver.task_tcb,                                         // Task control block
+                                    cfg->core_id == 0 || cfg->core_id == 1 ? cfg->core_id : tskNO_AFFINITY  // Core ID
+      );
+  handle->ctx.receiver.receive_task_handle = handle->ctx.receiver.task;
+
+  if (!handle->ctx.receiver.task) {
+    ESP_LOGE(TAG, "Receiver start: Failed to create receiver task");
+    handle->ctx.receiver.state = VBAN_RECEIVER_STATE_IDLE;
+    if (stage->running) {
+      stage->running = false;
+      xSemaphoreGive(stage->ready);
+    }
+    return ESP_ERR_VBAN_TASK_CREATE_FAIL;
+  }
+  return ESP_OK;
+}
+
+esp_err_t vban_receiver_stop(vban_handle_t handle) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (handle->ctx.receiver.reactor) {
+    ESP_LOGW(TAG, "Receiver stop: Receiver is served by a reactor, remove it from the reactor instead.");
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+
+  if (handle->ctx.receiver.state != VBAN_RECEIVER_STATE_RUNNING || !handle->ctx.receiver.receive_task_handle) {
+    ESP_LOGI(TAG, "Receiver stop: Not running or no task handle.");
+    // If task was created but never ran or already exited, set to idle.
     handle->ctx.receiver.state = VBAN_RECEIVER_STATE_IDLE;
     handle->ctx.receiver.receive_task_handle = NULL;
     return ESP_ERR_VBAN_NOT_STARTED;
   }
 
+  // The task checks this flag and exits. A task blocked in recvfrom() notices it within the socket's receive
+  // timeout (VBAN_RECEIVE_TIMEOUT_MS), so the socket stays open and usable for a later start.
   handle->ctx.receiver.state = VBAN_RECEIVER_STATE_STOPPING;
 
-  // The task checks this flag and should exit.
-  // If the socket is blocking, recvfrom will keep blocking.
-  // One way to unblock recvfrom is to close the socket from another task.
-  // This can cause recvfrom to return an error, which the task should handle.
-  // Closing socket here can be an option if task doesn't exit by flag alone.
-  // For now, assume task loop handles the state change.
-  // A more robust shutdown involves using an event or queue to signal the task,
-  // or ensuring the socket has a timeout.
-
-  // If socket is blocking and task is stuck in recvfrom, closing the socket
-  // from this context might be necessary to unblock it.
-  // This is a common pattern but can make error handling in the task tricky.
-  // For simplicity, we'll rely on the task checking the state.
-  // If using a non-blocking socket or a socket with timeout, this is cleaner.
-
-  // Shutdown the socket to interrupt recvfrom if it's blocking
-  if (handle->sock_fd >= 0) {
-    shutdown(handle->sock_fd, SHUT_RDWR);  // This should make recvfrom return.
-  }
-
   // Wait for task to terminate (optional, with timeout)
   // For simplicity, we don't wait here. The task should clean itself up.
   // If vTaskDelete is called on receive_task_handle directly, it's not clean if task is running.
-  // The task should delete itself (vTaskDelete(NULL)).
+  // The task parks itself and is deleted by the next start or by delete.
+
+  // Wake a reader blocked in vban_receiver_read()/vban_receiver_peek() so it can observe the stop
+  if (handle->ctx.receiver.pull_data_ready) {
+    xSemaphoreGive(handle->ctx.receiver.pull_data_ready);
+  }
 
   ESP_LOGI(TAG, "Receiver stop: Signaled receiver task to stop.");
   // The task will set handle->ctx.receiver.receive_task_handle to NULL when it exits.
   // We cannot guarantee immediate stop here.
   return ESP_OK;
-}
\ No newline at end of file
+}
+
+esp_err_t vban_receiver_select_stream(vban_handle_t handle, const char* stream_name, uint32_t crossfade_ms) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (!stream_name || !stream_name[0] || strlen(stream_name) >= VBAN_STREAM_NAME_MAX_LEN) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+  const vban_receiver_config_t* cfg = &handle->ctx.receiver.config;
+  if (cfg->fec_group_size > 0 || cfg->backup_stream_name[0]) {
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+
+  // The stages are allocated once, on the first crossfade, and kept for later switches
+  vban_crossfade_rx_t* crossfade = &handle->ctx.receiver.crossfade;
+  if (cfg->pull_enabled && crossfade_ms > 0 && !crossfade->stage_old.is_initialized) {
+    size_t stage_bytes = VBAN_CROSSFADE_STAGE_FRAMES * handle->ctx.receiver.pull_frame_bytes;
+    if (!vban_ring_init(handle->arena, &crossfade->stage_new, stage_bytes) ||
+        !vban_ring_init(handle->arena, &crossfade->stage_old, stage_bytes)) {
+      ESP_LOGE(TAG, "Select stream: No memory for crossfade buffers");
+      circular_buffer_destroy(&crossfade->stage_new);
+      circular_buffer_destroy(&crossfade->stage_old);
+      return ESP_ERR_VBAN_NO_MEM;
+    }
+  }
+
+  // Picked up by the receiving task with its next packet
+  portENTER_CRITICAL(&crossfade->request_lock);
+  memset(crossfade->request_name, 0, sizeof(crossfade->request_name));
+  memcpy(crossfade->request_name, stream_name, strlen(stream_name));
+  crossfade->request_ms = crossfade_ms;
+  crossfade->request_pending = true;
+  portEXIT_CRITICAL(&crossfade->request_lock);
+  return ESP_OK;
+}
+
+esp_err_t vban_receiver_get_stats(vban_handle_t handle, vban_receiver_stats_t* stats) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (!stats) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+  // Each block has one writer; the 32-bit counters are read as they are, the cycle sums under their sequence counters
+  *stats = handle->ctx.receiver.stats;
+  vban_stats_read_cycles(&handle->ctx.receiver.stats_seq, &handle->ctx.receiver.stats.process_cycles,
+                         &handle->ctx.receiver.stats.process_cycles_max, &stats->process_cycles, &stats->process_cycles_max);
+  vban_deliver_stats_t* deliver_stats = &handle->ctx.receiver.deliver_stats;
+  stats->pull_overruns = deliver_stats->pull_overruns;
+  stats->pull_path = deliver_stats->pull_path;
+  stats->passthrough_packets = deliver_stats->passthrough_packets;
+  stats->gate_idle_packets = deliver_stats->gate_idle_packets;
+  stats->gate_closes = deliver_stats->gate_closes;
+  vban_stats_read_cycles(&deliver_stats->seq, &deliver_stats->cycles, &deliver_stats->cycles_max, &stats->stage2_cycles,
+                         &stats->stage2_cycles_max);
+  TaskHandle_t task = handle->ctx.receiver.reactor ? handle->ctx.receiver.reactor->task : handle->ctx.receiver.task;
+  stats->task_stack_free_min = task ? uxTaskGetStackHighWaterMark(task) : 0;  // In bytes on ESP-IDF
+  return ESP_OK;
+}
+
+esp_err_t vban_receiver_get_failover_events(vban_handle_t handle, vban_failover_event_t* events, size_t max_events, size_t* num_events) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if ((!events && max_events > 0) || !num_events) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+
+  const vban_failover_rx_t* failover = &handle->ctx.receiver.failover;
+  uint32_t total = failover->num_events;
+  size_t count = total < VBAN_FAILOVER_EVENT_LOG_SIZE ? total : VBAN_FAILOVER_EVENT_LOG_SIZE;
+  if (count > max_events) {
+    count = max_events;
+  }
+  for (size_t i = 0; i < count; i++) {  // Oldest first
+    events[i] = failover->events[(total - count + i) % VBAN_FAILOVER_EVENT_LOG_SIZE];
+  }
+  *num_events = count;
+  return ESP_OK;
+}
+
+esp_err_t vban_receiver_get_streams(vban_handle_t handle, vban_stream_info_t* streams, size_t max_streams, size_t* num_streams) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if ((!streams && max_streams > 0) || !num_streams) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+  if (!handle->ctx.receiver.config.discovery_enabled) {
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+
+  // Packets age the table; without packets, silent streams are skipped here
+  vban_discovery_rx_t* discovery = &handle->ctx.receiver.discovery;
+  const int64_t now_us = esp_timer_get_time();
+  size_t count = 0;
+  portENTER_CRITICAL(&discovery->lock);
+  for (size_t i = 0; i < VBAN_DISCOVERY_MAX_STREAMS && count < max_streams; i++) {
+    const vban_discovery_entry_t* entry = &discovery->entries[i];
+    if (!entry->used || now_us - entry->info.last_seen_us > (int64_t)VBAN_DISCOVERY_TIMEOUT_MS * 1000) {
+      continue;
+    }
+    streams[count] = entry->info;
+    streams[count].packet_rate = entry->interval_us > 0 ? 1000000 / entry->interval_us : 0;
+    count++;
+  }
+  portEXIT_CRITICAL(&discovery->lock);
+
+  // Levels are read outside the critical section: the snapshot read may retry
+  if (handle->ctx.receiver.config.metering_enabled) {
+    for (size_t i = 0; i < count; i++) {
+      if (strncmp(streams[i].stream_name, handle->ctx.receiver.config.expected_stream_name, VBAN_STREAM_NAME_MAX_LEN) == 0) {
+        level_meter_read(&handle->ctx.receiver.meter, &streams[i].levels);
+      }
+    }
+  }
+  *num_streams = count;
+  return ESP_OK;
+}
+
+// --- Pull Interface ---
+
+static HOT_PATH_ATTR TickType_t vban_remaining_ticks(TickType_t start, uint32_t timeout_ms) {
+  if (timeout_ms == VBAN_WAIT_FOREVER) {
+    return portMAX_DELAY;
+  }
+  TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+  TickType_t elapsed = xTaskGetTickCount() - start;
+  return elapsed >= timeout ? 0 : timeout - elapsed;
+}
+
+HOT_PATH_ATTR esp_err_t vban_receiver_read(vban_handle_t handle, void* dst, size_t frames, uint32_t timeout_ms, size_t* frames_read) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (!dst && frames > 0) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+  if (!handle->ctx.receiver.config.pull_enabled) {
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+
+  const size_t frame_bytes = handle->ctx.receiver.pull_frame_bytes;
+  TickType_t start = xTaskGetTickCount();
+  size_t done = 0;
+
+  while (true) {
+    xSemaphoreTake(handle->ctx.receiver.pull_mutex, portMAX_DELAY);
+    size_t readable_bytes = 0;
+    const void* region = circular_buffer_get_readable_region(&handle->ctx.receiver.pull_ring, &readable_bytes);
+    xSemaphoreGive(handle->ctx.receiver.pull_mutex);
+
+    // As in vban_receiver_peek(), the buffered frames stay in place until consumed, so they are copied without the
+    // lock: a copy offloaded to the DMA blocks this task, and must not stall the receive task on the mutex meanwhile
+    size_t available = readable_bytes / frame_bytes;
+    size_t n = available < frames - done ? available : frames - done;
+    if (n > 0) {
+      dma_copy((uint8_t*)dst + done * frame_bytes, region, n * frame_bytes);
+      xSemaphoreTake(handle->ctx.receiver.pull_mutex, portMAX_DELAY);
+      circular_buffer_consume(&handle->ctx.receiver.pull_ring, n * frame_bytes);
+      xSemaphoreGive(handle->ctx.receiver.pull_mutex);
+    }
+    done += n;
+
+    if (done == frames) {
+      break;
+    }
+    // Checked before every wait, so a reader woken by vban_receiver_stop() returns instead of waiting again
+    if (handle->ctx.receiver.state != VBAN_RECEIVER_STATE_RUNNING) {
+      if (frames_read) {
+        *frames_read = done;
+      }
+      return ESP_ERR_VBAN_INVALID_STATE;
+    }
+    TickType_t wait_ticks = vban_remaining_ticks(start, timeout_ms);
+    if (wait_ticks == 0 || xSemaphoreTake(handle->ctx.receiver.pull_data_ready, wait_ticks) != pdTRUE) {
+      break;
+    }
+  }
+
+  if (frames_read) {
+    *frames_read = done;
+  }
+  return done == frames ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+HOT_PATH_ATTR esp_err_t vban_receiver_peek(vban_handle_t handle, const void** data, size_t* frames, uint32_t timeout_ms) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (!data || !frames) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+  if (!handle->ctx.receiver.config.pull_enabled) {
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+
+  TickType_t start = xTaskGetTickCount();
+  while (true) {
+    xSemaphoreTake(handle->ctx.receiver.pull_mutex, portMAX_DELAY);
+    size_t readable_bytes = 0;
+    const void* region = circular_buffer_get_readable_region(&handle->ctx.receiver.pull_ring, &readable_bytes);
+    xSemaphoreGive(handle->ctx.receiver.pull_mutex);
+
+    // Thanks to the mirrored ring, all buffered frames are contiguous. The receive task only appends
+    // behind them, so the region stays valid after the lock is dropped.
+    size_t available = readable_bytes / handle->ctx.receiver.pull_frame_bytes;
+    if (available > 0) {
+      *data = region;
+      *frames = available;
+      return ESP_OK;
+    }
+    // Frames still buffered after a stop are returned above; once they are gone a stopped receiver never fills the ring
+    if (handle->ctx.receiver.state != VBAN_RECEIVER_STATE_RUNNING) {
+      *data = NULL;
+      *frames = 0;
+      return ESP_ERR_VBAN_INVALID_STATE;
+    }
+
+    TickType_t wait_ticks = vban_remaining_ticks(start, timeout_ms);
+    if (wait_ticks == 0 || xSemaphoreTake(handle->ctx.receiver.pull_data_ready, wait_ticks) != pdTRUE) {
+      *data = NULL;
+      *frames = 0;
+      return ESP_ERR_TIMEOUT;
+    }
+  }
+}
+
+HOT_PATH_ATTR esp_err_t vban_receiver_release(vban_handle_t handle, size_t frames) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (!handle->ctx.receiver.config.pull_enabled) {
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+
+  xSemaphoreTake(handle->ctx.receiver.pull_mutex, portMAX_DELAY);
+  int ret = circular_buffer_consume(&handle->ctx.receiver.pull_ring, frames * handle->ctx.receiver.pull_frame_bytes);
+  xSemaphoreGive(handle->ctx.receiver.pull_mutex);
+
+  return ret == CB_SUCCESS ? ESP_OK : ESP_ERR_VBAN_INVALID_ARG;
+}
+
+esp_err_t vban_receiver_get_pull_format(vban_handle_t handle, vban_audio_format_t* format) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (!format) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+  if (!handle->ctx.receiver.config.pull_enabled) {
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+  *format = handle->ctx.receiver.config.pull_format;
+  return ESP_OK;
+}
+
+esp_err_t vban_receiver_get_levels(vban_handle_t handle, level_meter_levels_t* levels) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (!levels) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+  if (!handle->ctx.receiver.config.metering_enabled) {
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+  level_meter_read(&handle->ctx.receiver.meter, levels);
+  return ESP_OK;
+}
+
+esp_err_t vban_receiver_get_idle(vban_handle_t handle, bool* idle) {
+  if (!handle || handle->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (!idle) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+  if (handle->ctx.receiver.config.silence_gate_ms == 0) {
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+  *idle = handle->ctx.receiver.gate.idle;
+  return ESP_OK;
+}
+
+// --- Reactor Implementation ---
+
+static void vban_reactor_task(void* pvParameters) {
+  vban_reactor_handle_t reactor = (vban_reactor_handle_t)pvParameters;
+
+  ESP_LOGI(TAG, "VBAN Reactor task started");  // Set running by vban_reactor_start()
+  alloc_guard_watch_task(NULL);
+
+  while (reactor->state == VBAN_RECEIVER_STATE_RUNNING) {
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    int max_fd = -1;
+
+    xSemaphoreTake(reactor->mutex, portMAX_DELAY);
+    for (size_t i = 0; i < reactor->num_receivers; i++) {
+      int fd = reactor->receivers[i]->sock_fd;
+      FD_SET(fd, &read_fds);
+      if (fd > max_fd) max_fd = fd;
+    }
+    xSemaphoreGive(reactor->mutex);
+
+    if (max_fd < 0) {  // Nothing to serve yet
+      vTaskDelay(pdMS_TO_TICKS(VBAN_REACTOR_POLL_INTERVAL_MS));
+      continue;
+    }
+
+    struct timeval timeout = {.tv_sec = 0, .tv_usec = VBAN_REACTOR_POLL_INTERVAL_MS * 1000};
+    int ready = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
+    if (ready < 0) {
+      if (errno != EINTR) {
+        ESP_LOGE(TAG, "Reactor task: select failed: %s", strerror(errno));
+        vTaskDelay(pdMS_TO_TICKS(100));  // Wait a bit before retrying on error
+      }
+      continue;
+    }
+    if (ready == 0) {
+      continue;
+    }
+
+    // Drain every ready socket into the shared slots and dispatch to its receiver in place.
+    // The membership may have changed since select(); a socket that is no longer ready simply yields no packet.
+    // Callbacks run under the lock, so that a receiver is never removed mid-batch (they must not add or remove).
+    xSemaphoreTake(reactor->mutex, portMAX_DELAY);
+    for (size_t i = 0; i < reactor->num_receivers && reactor->state == VBAN_RECEIVER_STATE_RUNNING; i++) {
+      vban_handle_t receiver = reactor->receivers[i];
+      if (!FD_ISSET(receiver->sock_fd, &read_fds)) {
+        continue;
+      }
+      size_t num_packets = vban_receiver_drain(receiver, reactor->rx_slots, reactor->batch_packets, reactor->max_batch_packets, false);
+      if (num_packets > 0) {
+        vban_receiver_process_batch(receiver, reactor->rx_slots, reactor->max_batch_packets, reactor->batch_packets, num_packets);
+      }
+    }
+    xSemaphoreGive(reactor->mutex);
+  }
+
+  ESP_LOGI(TAG, "VBAN Reactor task stopping.");
+  alloc_guard_unwatch_task(NULL);
+  reactor->task_handle = NULL;
+  reactor->state = VBAN_RECEIVER_STATE_IDLE;
+  vTaskSuspend(NULL);  // Park; deleted by vban_task_reap()
+}
+
+vban_reactor_handle_t vban_reactor_create(const vban_reactor_config_t* config) {
+  if (!config) {
+    ESP_LOGE(TAG, "Reactor create: Invalid arguments");
+    return NULL;
+  }
+
+  vban_reactor_handle_t reactor = (vban_reactor_handle_t)vban_mem_alloc(config->arena, sizeof(struct vban_reactor_s));
+  if (!reactor) {
+    ESP_LOGE(TAG, "Reactor create: No memory for handle");
+    return NULL;
+  }
+
+  memcpy(&reactor->config, config, sizeof(vban_reactor_config_t));
+  reactor->state = VBAN_RECEIVER_STATE_IDLE;
+  reactor->max_batch_packets = config->max_batch_packets > 0 ? config->max_batch_packets : VBAN_DEFAULT_BATCH_PACKETS;
+  reactor->arena = config->arena;
+  reactor->pool = vban_pool_get(config->arena);
+  reactor->task_stack_size = config->task_stack_size > 0 ? config->task_stack_size : VBAN_DEFAULT_TASK_STACK_SIZE;
+  reactor->task_stack = vban_task_stack_alloc(config->arena, config->task_stack, reactor->task_stack_size, &reactor->task_stack_owned);
+  if (!reactor->task_stack || packet_pool_reserve(reactor->pool, reactor->max_batch_packets) != ESP_OK) {
+    ESP_LOGE(TAG, "Reactor create: No memory for task stack and %d packet slots", (int)reactor->max_batch_packets);
+    if (reactor->task_stack_owned) heap_caps_free(reactor->task_stack);
+    vban_mem_free(config->arena, reactor);
+    return NULL;
+  }
+  reactor->mutex = vban_mutex_create(reactor->arena);
+  reactor->rx_slots = vban_slots_alloc(reactor->arena, reactor->pool, reactor->max_batch_packets);
+  reactor->batch_packets = (vban_packet_desc_t*)vban_mem_alloc(reactor->arena, reactor->max_batch_packets * sizeof(vban_packet_desc_t));
+  if (!reactor->mutex || !reactor->rx_slots || !reactor->batch_packets) {
+    ESP_LOGE(TAG, "Reactor create: No memory for %d packet slots", (int)reactor->max_batch_packets);
+    if (reactor->mutex) vSemaphoreDelete(reactor->mutex);
+    vban_slots_free(reactor->arena, reactor->pool, reactor->rx_slots, reactor->max_batch_packets);
+    packet_pool_unreserve(reactor->pool, reactor->max_batch_packets);
+    vban_mem_free(reactor->arena, reactor->batch_packets);
+    if (reactor->task_stack_owned) heap_caps_free(reactor->task_stack);
+    vban_mem_free(reactor->arena, reactor);
+    return NULL;
+  }
+  if (reactor->arena) {
+    reactor->arena->num_users++;
+  }
+
+  ESP_LOGI(TAG, "VBAN Reactor created");
+  return reactor;
+}
+
+esp_err_t vban_reactor_delete(vban_reactor_handle_t reactor) {
+  if (!reactor) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+
+  vban_reactor_stop(reactor);  // The task notices the stop request within one select() timeout, then parks
+  if (vban_task_reap(&reactor->task) != ESP_OK) {
+    ESP_LOGE(TAG, "Reactor delete: Task did not stop, reactor not deleted");
+    return ESP_ERR_TIMEOUT;
+  }
+
+  while (reactor->num_receivers > 0) {
+    vban_reactor_remove_receiver(reactor, reactor->receivers[0]);
+  }
+
+  vSemaphoreDelete(reactor->mutex);
+  vban_slots_free(reactor->arena, reactor->pool, reactor->rx_slots, reactor->max_batch_packets);
+  packet_pool_unreserve(reactor->pool, reactor->max_batch_packets);
+  vban_mem_free(reactor->arena, reactor->batch_packets);
+  if (reactor->task_stack_owned) {
+    heap_caps_free(reactor->task_stack);
+  }
+  vban_arena_handle_t arena = reactor->arena;
+  vban_mem_free(arena, reactor);
+  if (arena) {
+    arena->num_users--;
+  }
+  ESP_LOGI(TAG, "VBAN Reactor deleted");
+  return ESP_OK;
+}
+
+esp_err_t vban_reactor_start(vban_reactor_handle_t reactor) {
+  if (!reactor) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (reactor->state != VBAN_RECEIVER_STATE_IDLE || reactor->task_handle != NULL) {
+    ESP_LOGW(TAG, "Reactor start: Already started or not idle.");
+    return ESP_ERR_VBAN_ALREADY_STARTED;
+  }
+
+  esp_err_t err = vban_task_reap(&reactor->task);
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  const vban_reactor_config_t* cfg = &reactor->config;
+  // Running from here on, so that a stop issued before the task runs is not lost (the task exits right away)
+  reactor->state = VBAN_RECEIVER_STATE_RUNNING;
+  reactor->task =
+      xTaskCreateStaticPinnedToCore(vban_reactor_task,
+                                    "vban_reactor",                                                         // Task name
+                                    reactor->task_stack_size,                                               // Stack size
+                                    (void*)reactor,                                                         // Parameter
+                                    cfg->task_priority > 0 ? cfg->task_priority : (tskIDLE_PRIORITY + 5),   // Priority
+                                    reactor->task_stack,                                                    // Stack
+                                    &reactor->task_tcb,                                                     // Task control block
+                                    cfg->core_id == 0 || cfg->core_id == 1 ? cfg->core_id : tskNO_AFFINITY  // Core ID
+      );
+  reactor->task_handle = reactor->task;
+
+  if (!reactor->task) {
+    ESP_LOGE(TAG, "Reactor start: Failed to create reactor task");
+    reactor->state = VBAN_RECEIVER_STATE_IDLE;
+    return ESP_ERR_VBAN_TASK_CREATE_FAIL;
+  }
+  return ESP_OK;
+}
+
+esp_err_t vban_reactor_stop(vban_reactor_handle_t reactor) {
+  if (!reactor) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (reactor->state != VBAN_RECEIVER_STATE_RUNNING || !reactor->task_handle) {
+    return ESP_ERR_VBAN_NOT_STARTED;
+  }
+
+  // Sockets stay open (they belong to the receivers); the task exits at the next select() timeout at the latest
+  reactor->state = VBAN_RECEIVER_STATE_STOPPING;
+  ESP_LOGI(TAG, "Reactor stop: Signaled reactor task to stop.");
+  return ESP_OK;
+}
+
+esp_err_t vban_reactor_add_receiver(vban_reactor_handle_t reactor, vban_handle_t receiver) {
+  if (!reactor || !receiver || receiver->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (receiver->ctx.receiver.reactor || receiver->ctx.receiver.receive_task_handle != NULL ||
+      receiver->ctx.receiver.state != VBAN_RECEIVER_STATE_IDLE) {
+    ESP_LOGW(TAG, "Reactor add: Receiver already running or attached.");
+    return ESP_ERR_VBAN_INVALID_STATE;
+  }
+  if (receiver->pool != reactor->pool) {  // Packets move between the reactor's slots and the receiver's stages
+    ESP_LOGE(TAG, "Reactor add: Receiver and reactor must be created from the same arena");
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+
+  esp_err_t ret = ESP_OK;
+  xSemaphoreTake(reactor->mutex, portMAX_DELAY);
+  if (reactor->num_receivers >= VBAN_REACTOR_MAX_RECEIVERS) {
+    ret = ESP_ERR_VBAN_NO_MEM;
+  } else {
+    reactor->receivers[reactor->num_receivers++] = receiver;
+    receiver->ctx.receiver.reactor = reactor;
+    receiver->ctx.receiver.state = VBAN_RECEIVER_STATE_RUNNING;
+  }
+  xSemaphoreGive(reactor->mutex);
+
+  if (ret != ESP_OK) {
+    ESP_LOGE(TAG, "Reactor add: Already serving %d receivers", VBAN_REACTOR_MAX_RECEIVERS);
+  }
+  return ret;
+}
+
+esp_err_t vban_reactor_remove_receiver(vban_reactor_handle_t reactor, vban_handle_t receiver) {
+  if (!reactor || !receiver || receiver->type != VBAN_INSTANCE_TYPE_RECEIVER) {
+    return ESP_ERR_VBAN_INVALID_HANDLE;
+  }
+  if (receiver->ctx.receiver.reactor != reactor) {
+    return ESP_ERR_VBAN_INVALID_ARG;
+  }
+
+  // Once the mutex is taken, the reactor task is not processing this receiver and will not touch it again
+  xSemaphoreTake(reactor->mutex, portMAX_DELAY);
+  for (size_t i = 0; i < reactor->num_receivers; i++) {
+    if (reactor->receivers[i] == receiver) {
+      reactor->receivers[i] = reactor->receivers[--reactor->num_receivers];
+      break;
+    }
+  }
+  if (receiver->ctx.receiver.config.fec_group_size > 0) {
+    vban_fec_finish(receiver);  // Delivered on this task, while the reactor is kept out by the mutex
+  }
+  receiver->ctx.receiver.reactor = NULL;
+  receiver->ctx.receiver.state = VBAN_RECEIVER_STATE_IDLE;
+  xSemaphoreGive(reactor->mutex);
+  if (receiver->ctx.receiver.pull_data_ready) {
+    xSemaphoreGive(receiver->ctx.receiver.pull_data_ready);  // Wake a blocked reader, as vban_receiver_stop() does
+  }
+  return ESP_OK;
+}
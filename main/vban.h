@@ -1,10 +1,12 @@
 #ifndef VBAN_H_
 #define VBAN_H_
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
-#include "esp_err.h"  // For esp_err_t
+#include "esp_err.h"      // For esp_err_t
+#include "level_meter.h"  // For level_meter_levels_t
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,12 +22,37 @@ extern "C" {
 #define VBAN_MAX_PACKET_SIZE (VBAN_HEADER_SIZE + VBAN_MAX_PAYLOAD_SIZE)  // 1464 bytes
 #define VBAN_STREAM_NAME_MAX_LEN 16
 #define VBAN_MAGIC_NUMBER 0x4E414256  // 'VBAN' (In little-endian, 'N','A','B','V')
+#define VBAN_DEFAULT_BATCH_PACKETS 8          // Max packets drained from the socket per batch (receiver default)
+#define VBAN_DEFAULT_PULL_BUFFER_FRAMES 4096  // Capacity of the receiver pull ring in frames (about 85 ms at 48 kHz)
+#define VBAN_WAIT_FOREVER UINT32_MAX          // Timeout value for blocking calls that never time out
+#define VBAN_REACTOR_MAX_RECEIVERS 8          // Max receivers served by one reactor task
+#define VBAN_DEFAULT_TASK_STACK_SIZE 3072     // Stack of the receiver and reactor tasks in bytes (see task_stack_free_min)
+#define VBAN_DEFAULT_FAILOVER_TIMEOUT_MS 10   // Silence on the active stream before the receiver switches to the other one
+#define VBAN_FAILOVER_HOLD_PACKETS 8          // Packets of the standby stream held to fill gaps and to switch without a gap
+#define VBAN_DEFAULT_STAGE_QUEUE_PACKETS 16   // Depth of the queue between the two stages of a staged receiver
+#define VBAN_DISCOVERY_MAX_STREAMS 8          // Streams tracked by the discovery table of a receiver
+#define VBAN_DISCOVERY_TIMEOUT_MS 5000        // Silence after which a stream leaves the discovery table
+#define VBAN_FAILOVER_EVENT_LOG_SIZE 8        // Failover events kept per receiver (oldest are overwritten)
+#define VBAN_CROSSFADE_STAGE_FRAMES 1024      // Frames of each stream buffered while crossfading (bounds the skew between them)
+#define VBAN_LEVEL_WINDOW_MS 50               // Window of the peak and RMS levels published by a metering receiver
+
+// Forward error correction (XOR parity)
+// After every group of N audio packets (frame_counter k*N .. k*N+N-1) a sender with FEC enabled sends one parity
+// packet on a companion stream (see vban_fec_get_stream_name()). Its header uses VBAN_SUBPROTOCOL_USER, carries N-1 in
+// samples_per_frame_m1 and k*N in frame_counter. The payload is the XOR of header bytes 4-7 (32 bits), the XOR of the
+// payload lengths (16 bits), 2 zero bytes, then the XOR of the zero-padded payloads. Any single lost packet of a group
+// can be rebuilt from the other N-1 and the parity; the cost is 1/N extra bandwidth and N packets of receive latency.
+#define VBAN_FEC_MAX_GROUP_SIZE 16    // Max audio packets protected by one parity packet (group sizes are powers of two)
+#define VBAN_FEC_STREAM_SUFFIX "#FEC"  // Appended to the (truncated) stream name to form the parity stream name
+#define VBAN_FEC_PARITY_PREFIX_SIZE 8  // Format word XOR, length XOR and 2 reserved bytes before the payload XOR
+#define VBAN_FEC_MAX_PACKET_SIZE (VBAN_MAX_PACKET_SIZE + VBAN_FEC_PARITY_PREFIX_SIZE)  // 1472 bytes, fits a 1500-byte MTU
 
 // Sub-protocol Identifiers - Page 8
 #define VBAN_SUBPROTOCOL_AUDIO 0x00
 #define VBAN_SUBPROTOCOL_SERIAL 0x20
 #define VBAN_SUBPROTOCOL_TEXT 0x40
 #define VBAN_SUBPROTOCOL_SERVICE 0x60
+#define VBAN_SUBPROTOCOL_USER 0xE0  // User defined, used for FEC parity packets
 // Other sub-protocols will be added in the future
 
 // Audio Codec Identifiers - Page 10
@@ -144,6 +171,11 @@ typedef struct {
   // vban_codec_t             codec;        // For now, only PCM is supported, implicitly VBAN_CODEC_PCM
 } vban_audio_format_t;
 
+/**
+ * @brief Opaque handle for a memory arena that VBAN instances are carved from (see vban_arena_create()).
+ */
+typedef struct vban_arena_s* vban_arena_handle_t;
+
 /**
  * @brief VBAN Sender Configuration
  */
@@ -152,6 +184,8 @@ typedef struct {
   char dest_ip[16];                            ///< Destination IP address (e.g., "192.168.1.100")
   uint16_t dest_port;                          ///< Destination UDP port (default: VBAN_DEFAULT_PORT)
   vban_audio_format_t audio_format;            ///< Format of the audio to be sent
+  uint8_t fec_group_size;                      ///< Send a parity packet after every N audio packets (0 to disable, or 2, 4, 8, 16)
+  vban_arena_handle_t arena;                   ///< Arena to allocate the sender from (NULL to use the heap)
   // uint8_t sub_protocol;                    // For future expansion, default VBAN_SUBPROTOCOL_AUDIO
 } vban_sender_config_t;
 
@@ -168,29 +202,218 @@ typedef struct {
 typedef void (*vban_audio_receive_callback_t)(const vban_header_t* header, const uint8_t* audio_data, size_t audio_data_len,
                                               const char* sender_ip, uint16_t sender_port, void* user_context);
 
+/**
+ * @brief Descriptor of one received VBAN audio packet, as delivered to the batch callback.
+ * All pointers are valid only for the duration of the callback invocation.
+ */
+typedef struct {
+  const vban_header_t* header;  ///< Pointer to the received VBAN header
+  const uint8_t* audio_data;    ///< Pointer to the start of the audio payload
+  size_t audio_data_len;        ///< Length of the audio payload in bytes
+  int64_t arrival_time_us;      ///< Arrival time of the packet (esp_timer_get_time(), in microseconds)
+  uint32_t sender_id;           ///< Sender IPv4 address (network byte order), usable as a sender ID
+  uint16_t sender_port;         ///< Sender UDP port
+} vban_packet_desc_t;
+
+/**
+ * @brief Callback function type for a batch of received VBAN audio packets.
+ *
+ * Invoked once per drained burst with every accepted packet of that burst, in arrival order.
+ *
+ * @param packets Array of packet descriptors.
+ * @param num_packets Number of descriptors in the array (at least 1).
+ * @param user_context User context provided during receiver creation.
+ */
+typedef void (*vban_audio_batch_callback_t)(const vban_packet_desc_t* packets, size_t num_packets, void* user_context);
+
 /**
  * @brief VBAN Receiver Configuration
  */
 typedef struct {
   char expected_stream_name[VBAN_STREAM_NAME_MAX_LEN];  ///< Only process packets with this stream name (empty to accept any)
   uint16_t listen_port;                                 ///< UDP port to listen on (default: VBAN_DEFAULT_PORT)
-  vban_audio_receive_callback_t audio_callback;         ///< Callback for received audio packets
+  vban_audio_receive_callback_t audio_callback;         ///< Callback for received audio packets (called once per packet)
+  vban_audio_batch_callback_t audio_batch_callback;     ///< Callback for batches of packets (takes precedence over audio_callback)
   void* user_context;                                   ///< User context for the callback
+  size_t max_batch_packets;                             ///< Max packets per batch (0 for VBAN_DEFAULT_BATCH_PACKETS)
   // uint8_t accepted_sub_protocols_mask;              // For future expansion
   int core_id;             ///< CPU core to run the receiver task on (0, 1, or tskNO_AFFINITY)
   int task_priority;       ///< Priority of the receiver task (1-configMAX_PRIORITIES-1)
-  size_t task_stack_size;  ///< Stack size for the receiver task (e.g., 4096)
+  size_t task_stack_size;  ///< Stack size for the receiver task in bytes (0 for VBAN_DEFAULT_TASK_STACK_SIZE)
+  void* task_stack;        ///< Internal RAM of task_stack_size bytes for the stack (NULL: from the arena, else the heap)
+  // Pull interface (optional, see vban_receiver_read())
+  bool pull_enabled;                ///< Buffer converted PCM in the receiver for vban_receiver_read()/vban_receiver_peek()
+  vban_audio_format_t pull_format;  ///< Format of the pulled PCM. Packets with another sample rate or channel count are dropped,
+                                    ///< data_type is the output type (VBAN_DATATYPE_INT16, _INT32 or _FLOAT32)
+  size_t pull_buffer_frames;        ///< Capacity of the pull ring in frames (0 for VBAN_DEFAULT_PULL_BUFFER_FRAMES)
+  // Forward error correction (optional, requires expected_stream_name)
+  uint8_t fec_group_size;  ///< Group size N used by the sender (0 to disable). Packets are delivered per completed group;
+                           ///< a partial group is delivered when the receiver stops or leaves its reactor
+  // Redundant senders (optional, requires expected_stream_name, not combinable with FEC)
+  char backup_stream_name[VBAN_STREAM_NAME_MAX_LEN];  ///< Identical stream from a second sender (empty to disable)
+  uint32_t failover_timeout_ms;                       ///< Silence before switching streams (0 for VBAN_DEFAULT_FAILOVER_TIMEOUT_MS)
+  // Two-stage pipeline (optional, dedicated receiver task only): the receiver task (stage 1) receives, validates and
+  // sequences (FEC, failover) packets and queues them to a stage 2 task, which converts them into the pull ring
+  // (crossfades included) and runs the callbacks. Pin the stages to different cores to run them in parallel.
+  bool staged;                  ///< Run delivery in a stage 2 task
+  int stage2_core_id;           ///< CPU core to run the stage 2 task on (0, 1, or tskNO_AFFINITY)
+  int stage2_task_priority;     ///< Priority of the stage 2 task (0 for task_priority)
+  size_t stage2_queue_packets;  ///< Packets queued between the stages, a power of two (0 for VBAN_DEFAULT_STAGE_QUEUE_PACKETS)
+  // Stream discovery (optional, see vban_receiver_get_streams())
+  bool discovery_enabled;  ///< Track every audio stream arriving on the port, whether it is played or not
+  // Level metering (optional, requires pull_enabled, see vban_receiver_get_levels())
+  bool metering_enabled;  ///< Meter peak, RMS and clips of the pulled PCM inside the conversion (and passthrough) loops
+  // Silence gate (optional, requires pull_enabled, see vban_receiver_get_idle())
+  uint32_t silence_gate_ms;    ///< Silence after which the pull path goes idle: the last silent packet is ramped down, and
+                               ///< silent packets are then dropped before conversion until one exceeds the threshold (0: off)
+  uint16_t silence_threshold;  ///< Peak (on the 16-bit meter scale) up to which a packet is silent (0: digital silence only);
+                               ///< an idle gate re-opens above twice this level
+  vban_arena_handle_t arena;  ///< Arena to allocate the receiver (handle, rings, packet buffers) from (NULL to use the heap)
 } vban_receiver_config_t;
 
+/**
+ * @brief Path taken by packets into the pull ring
+ */
+typedef enum {
+  VBAN_PULL_PATH_NONE = 0,     ///< No packet has reached the pull ring yet
+  VBAN_PULL_PATH_CONVERT,      ///< Samples converted to pull_format (different sample type, or crossfading)
+  VBAN_PULL_PATH_PASSTHROUGH,  ///< Stream already in pull_format: payload copied into the ring as-is (bit-perfect)
+} vban_pull_path_t;
+
+/**
+ * @brief VBAN Receiver Statistics
+ * Counters are maintained without locking by the task that counts them: the receiving task, or stage 2 of a staged
+ * receiver for the pull path, silence gate and stage 2 counters. vban_receiver_get_stats() merges the two; the cycle
+ * sums are read consistently, the other counters may be from slightly different moments.
+ */
+typedef struct {
+  uint32_t packets_received;     ///< Datagrams read from the socket
+  uint32_t packets_accepted;     ///< Audio packets that passed validation
+  uint32_t fast_path_packets;    ///< Accepted packets classified by the precomputed format word (no full header parse);
+                                 ///< with CONFIG_VBAN_FIXED_FORMAT, the build-time stream's word
+  uint32_t pull_overruns;        ///< Packets dropped because the pull ring was full
+  uint32_t fec_recovered;        ///< Lost packets rebuilt from a parity packet
+  uint32_t fec_unrecoverable;    ///< Lost packets of groups that could not be repaired (two or more losses, or no parity),
+                                 ///< including groups lost entirely
+  uint32_t failovers;            ///< Switches between the primary and the backup stream
+  uint32_t failover_gap_fills;   ///< Packets lost on the active stream and taken from the standby stream instead
+  uint32_t task_stack_free_min;  ///< Least free stack of the receiving task so far, in bytes (0 without a task)
+  uint64_t process_cycles;       ///< CPU cycles spent delivering accepted packets (conversion, FEC, failover, callbacks;
+                                 ///< staged: FEC, failover and queueing only)
+  uint32_t process_cycles_max;   ///< Most CPU cycles spent delivering one batch
+  // Pull receivers only
+  vban_pull_path_t pull_path;    ///< Path of the last packet written to the pull ring
+  uint32_t passthrough_packets;  ///< Packets written to the pull ring by the passthrough path
+  uint32_t gate_idle_packets;    ///< Packets dropped unconverted by the idle silence gate (work saved)
+  uint32_t gate_closes;          ///< Times the silence gate went idle
+  // Staged receivers only
+  uint32_t stage_drops;          ///< Packets dropped because the queue to stage 2 or the packet pool was full
+  uint64_t stage2_cycles;        ///< CPU cycles spent by stage 2 (conversion, crossfade, callbacks)
+  uint32_t stage2_cycles_max;    ///< Most CPU cycles spent by stage 2 on one batch
+} vban_receiver_stats_t;
+
+/**
+ * @brief A stream seen by a receiver (see vban_receiver_get_streams()).
+ */
+typedef struct {
+  char stream_name[VBAN_STREAM_NAME_MAX_LEN + 1];  ///< Stream name (NUL-terminated)
+  uint32_t sender_id;                              ///< Sender IPv4 address (network byte order)
+  uint16_t sender_port;                            ///< Sender UDP port
+  vban_audio_format_t format;                      ///< Sample rate index, channels and sample type of the last packet
+  uint16_t frames_per_packet;                      ///< Frames in the last packet
+  uint32_t packet_rate;                            ///< Packets per second (from the average interval between packets)
+  int64_t last_seen_us;                            ///< Arrival time of the last packet (esp_timer_get_time(), in microseconds)
+  uint32_t packets;                                ///< Packets seen since the stream appeared
+  uint32_t lost;                                   ///< Packets missing from the frame_counter sequence (loss estimate)
+  level_meter_levels_t levels;                     ///< Levels of the played stream (expected_stream_name, metering_enabled only),
+                                                   ///< zero for the others
+} vban_stream_info_t;
+
+/**
+ * @brief Switch between the primary and the backup stream of a receiver.
+ */
+typedef struct {
+  int64_t time_us;         ///< Time of the switch (esp_timer_get_time(), in microseconds)
+  uint32_t outage_us;      ///< Time since the last packet of the stream that was left (detection time)
+  uint32_t frame_counter;  ///< First frame played from the new stream (in that stream's frame_counter)
+  bool to_backup;          ///< true: primary to backup, false: back to the primary
+} vban_failover_event_t;
+
 /**
  * @brief Opaque handle for a VBAN instance (sender or receiver).
  */
 typedef struct vban_instance_s* vban_handle_t;
 
+/**
+ * @brief VBAN Reactor Configuration
+ * A reactor is one task that serves the sockets of several receivers (different ports) with select(),
+ * instead of one task, stack and set of packet buffers per receiver.
+ */
+typedef struct {
+  int core_id;                ///< CPU core to run the reactor task on (0, 1, or tskNO_AFFINITY)
+  int task_priority;          ///< Priority of the reactor task (1-configMAX_PRIORITIES-1)
+  size_t task_stack_size;     ///< Stack size for the reactor task in bytes (0 for VBAN_DEFAULT_TASK_STACK_SIZE)
+  void* task_stack;           ///< Internal RAM of task_stack_size bytes for the stack (NULL: from the arena, else the heap)
+  size_t max_batch_packets;   ///< Max packets drained per ready socket (0 for VBAN_DEFAULT_BATCH_PACKETS)
+  vban_arena_handle_t arena;  ///< Arena to allocate the reactor from (NULL to use the heap), must match its receivers'
+} vban_reactor_config_t;
+
+/**
+ * @brief Opaque handle for a VBAN reactor.
+ */
+typedef struct vban_reactor_s* vban_reactor_handle_t;
+
 // -----------------------------------------------------------------------------
 // Function Prototypes
 // -----------------------------------------------------------------------------
 
+/**
+ * @brief Create a memory arena for a pipeline.
+ *
+ * Instances created with the arena in their configuration take everything they own (handle, packet buffers,
+ * semaphores, crossfade buffers) from it instead of the heap, at creation or start time; only the pull ring, which
+ * must be DMA-capable, comes from the DMA heap at creation time. The pipeline's
+ * footprint is thus fixed when it is configured, and no heap memory is allocated or freed while it streams, which
+ * keeps the heap from fragmenting over long uptimes. Packet buffers come from a pool private to the arena.
+ * Memory is not reused when an instance is deleted; it is released with the arena.
+ *
+ * @param size Size of the arena in bytes (see vban_arena_get_used() to size it).
+ * @param memory Memory to use (size bytes, e.g. a static array), or NULL to allocate one block from the heap.
+ * @return Handle to the arena, or NULL on failure.
+ */
+vban_arena_handle_t vban_arena_create(size_t size, void* memory);
+
+/**
+ * @brief Delete an arena.
+ *
+ * @param arena Handle to the arena.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_VBAN_INVALID_HANDLE: NULL handle
+ * - ESP_ERR_VBAN_INVALID_STATE: Instances created from the arena have not been deleted yet
+ */
+esp_err_t vban_arena_delete(vban_arena_handle_t arena);
+
+/**
+ * @brief Get the number of bytes of an arena in use.
+ *
+ * @param arena Handle to the arena.
+ * @return Bytes used (0 for a NULL handle).
+ */
+size_t vban_arena_get_used(vban_arena_handle_t arena);
+
+/**
+ * @brief Carve zeroed memory from an arena, for the application's buffers of the same pipeline.
+ *
+ * The memory is released with the arena and must not be used after vban_arena_delete().
+ *
+ * @param arena Handle to the arena.
+ * @param size Number of bytes.
+ * @param alignment Required alignment (power of two; 0 for the default of 8 bytes).
+ * @return Pointer to the memory, or NULL if the handle is NULL or the arena is exhausted.
+ */
+void* vban_arena_alloc(vban_arena_handle_t arena, size_t size, size_t alignment);
+
 /**
  * @brief Create a VBAN sender instance.
  *
@@ -234,30 +457,264 @@ vban_handle_t vban_receiver_create(const vban_receiver_config_t* config);
 
 /**
  * @brief Delete a VBAN receiver instance and release resources.
- * If the receiver task is running, it will be stopped first.
+ * If the receiver task is running, it will be stopped first, and the instance is released once its tasks have exited.
  *
  * @param handle Handle to the VBAN receiver instance.
- * @return ESP_OK on success, or an error code on failure.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if a task did not exit (the instance is not deleted), or another error
+ *         code on failure.
  */
 esp_err_t vban_receiver_delete(vban_handle_t handle);
 
 /**
  * @brief Start the VBAN receiver task.
  * The receiver will start listening for UDP packets and invoking the callback.
+ * The task blocks for the first packet of a burst, then drains the socket without blocking
+ * (up to max_batch_packets) before dispatching the whole burst.
  *
  * @param handle Handle to the VBAN receiver instance.
- * @return ESP_OK on success, or an error code on failure.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the task of the previous run did not exit, or another error code on
+ *         failure.
  */
 esp_err_t vban_receiver_start(vban_handle_t handle);
 
 /**
  * @brief Stop the VBAN receiver task.
+ * Returns without waiting: the task notices the stop within 100 ms even if no packets arrive (socket receive timeout),
+ * and exits before the next vban_receiver_start() or vban_receiver_delete() reuses or releases its memory.
  *
  * @param handle Handle to the VBAN receiver instance.
  * @return ESP_OK on success, or an error code on failure.
  */
 esp_err_t vban_receiver_stop(vban_handle_t handle);
 
+/**
+ * @brief Follow another stream, crossfading from the current one.
+ *
+ * Takes effect with the next received packet. For receivers with pull_enabled, both streams are buffered
+ * during the switch and the pulled PCM is an equal-power crossfade over crossfade_ms; afterwards the new
+ * stream is written directly again, so no latency remains. Callbacks receive the new stream's packets only.
+ * The old and new streams must have the pull format's sample rate and channel count.
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param stream_name Name of the stream to follow.
+ * @param crossfade_ms Length of the crossfade in milliseconds (0 for a hard cut).
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_VBAN_INVALID_ARG: Empty or too long stream name
+ * - ESP_ERR_VBAN_INVALID_STATE: The receiver uses FEC or a backup stream (their stream names are fixed)
+ * - ESP_ERR_VBAN_NO_MEM: No memory for the crossfade buffers
+ */
+esp_err_t vban_receiver_select_stream(vban_handle_t handle, const char* stream_name, uint32_t crossfade_ms);
+
+/**
+ * @brief Get the statistics of a VBAN receiver.
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param[out] stats Statistics snapshot.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t vban_receiver_get_stats(vban_handle_t handle, vban_receiver_stats_t* stats);
+
+/**
+ * @brief Get the recorded failover events of a receiver with a backup stream.
+ * Events are recorded by the receiving task and read without locking.
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param[out] events Array receiving the events, oldest first.
+ * @param max_events Capacity of the array.
+ * @param[out] num_events Number of events written (at most VBAN_FAILOVER_EVENT_LOG_SIZE).
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t vban_receiver_get_failover_events(vban_handle_t handle, vban_failover_event_t* events, size_t max_events, size_t* num_events);
+
+/**
+ * @brief Get the streams seen by a receiver created with discovery_enabled.
+ *
+ * Every audio stream arriving on the receiver's port is tracked, keyed by stream name and sender (address and
+ * port), whether it matches expected_stream_name or not: with an empty expected_stream_name this shows what is
+ * on the wire, and a stream can then be chosen with vban_receiver_select_stream(). At most
+ * VBAN_DISCOVERY_MAX_STREAMS streams are tracked (the least recently seen one makes room for a new one), and
+ * streams silent for VBAN_DISCOVERY_TIMEOUT_MS are dropped.
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param[out] streams Array receiving the streams.
+ * @param max_streams Capacity of the array.
+ * @param[out] num_streams Number of streams written.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_VBAN_INVALID_ARG: NULL array or count
+ * - ESP_ERR_VBAN_INVALID_STATE: The receiver was not created with discovery_enabled
+ * - Others: Error
+ */
+esp_err_t vban_receiver_get_streams(vban_handle_t handle, vban_stream_info_t* streams, size_t max_streams, size_t* num_streams);
+
+/**
+ * @brief Create a VBAN reactor.
+ * This does not start the reactor task yet. Call vban_reactor_start() to begin serving receivers.
+ *
+ * @param config Configuration for the reactor.
+ * @return Handle to the reactor, or NULL on failure.
+ */
+vban_reactor_handle_t vban_reactor_create(const vban_reactor_config_t* config);
+
+/**
+ * @brief Delete a VBAN reactor.
+ * The reactor task is stopped first and all receivers are detached (but not deleted).
+ *
+ * @param reactor Handle to the reactor.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the task did not exit (the reactor is not deleted), or another error
+ *         code on failure.
+ */
+esp_err_t vban_reactor_delete(vban_reactor_handle_t reactor);
+
+/**
+ * @brief Start the reactor task.
+ *
+ * @param reactor Handle to the reactor.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the task of the previous run did not exit, or another error code on
+ *         failure.
+ */
+esp_err_t vban_reactor_start(vban_reactor_handle_t reactor);
+
+/**
+ * @brief Stop the reactor task.
+ * Attached receivers stay attached and are served again after vban_reactor_start().
+ *
+ * @param reactor Handle to the reactor.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t vban_reactor_stop(vban_reactor_handle_t reactor);
+
+/**
+ * @brief Let a reactor serve a receiver.
+ * The receiver must not be started with vban_receiver_start(); its packets are received and dispatched
+ * (pull ring and callbacks) by the reactor task. Can be called while the reactor is running.
+ * The reactor runs the callbacks of its receivers with its lock held: a callback must not call
+ * vban_reactor_add_receiver(), vban_reactor_remove_receiver(), vban_reactor_delete() or vban_receiver_delete() for a
+ * receiver of the same reactor (it would deadlock). Do that from another task, e.g. after a notification.
+ *
+ * @param reactor Handle to the reactor.
+ * @param receiver Handle to a VBAN receiver instance.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_VBAN_INVALID_STATE: The receiver runs its own task or is already attached
+ * - ESP_ERR_VBAN_NO_MEM: The reactor already serves VBAN_REACTOR_MAX_RECEIVERS receivers
+ */
+esp_err_t vban_reactor_add_receiver(vban_reactor_handle_t reactor, vban_handle_t receiver);
+
+/**
+ * @brief Stop serving a receiver.
+ * When this returns, the reactor task no longer touches the receiver. vban_receiver_delete() does this implicitly.
+ * Must not be called from a callback of a receiver of the same reactor (see vban_reactor_add_receiver()).
+ *
+ * @param reactor Handle to the reactor.
+ * @param receiver Handle to a VBAN receiver instance attached to this reactor.
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t vban_reactor_remove_receiver(vban_reactor_handle_t reactor, vban_handle_t receiver);
+
+/**
+ * @brief Read converted PCM frames from a receiver created with pull_enabled.
+ *
+ * Blocks until the requested number of frames has been copied or the timeout expires.
+ * Frames are interleaved in the receiver's pull_format. Only one reader per receiver is supported.
+ * Frames buffered before a stop can still be read; once they are used up, a receiver that is not running (stopped,
+ * removed from its reactor, or not started) fails the call instead of blocking, and vban_receiver_stop() wakes a
+ * blocked reader.
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param dst Destination buffer (frames * num_channels * sample size bytes).
+ * @param frames Number of frames to read.
+ * @param timeout_ms Maximum time to wait in milliseconds (VBAN_WAIT_FOREVER to wait indefinitely, 0 to poll).
+ * @param[out] frames_read Number of frames actually copied. Can be NULL.
+ * @return
+ * - ESP_OK: All requested frames were read
+ * - ESP_ERR_TIMEOUT: Timeout expired, fewer frames were read
+ * - ESP_ERR_VBAN_INVALID_STATE: The receiver was not created with pull_enabled, or it is not running and fewer frames
+ *   were read (*frames_read of them)
+ * - Others: Error
+ */
+esp_err_t vban_receiver_read(vban_handle_t handle, void* dst, size_t frames, uint32_t timeout_ms, size_t* frames_read);
+
+/**
+ * @brief Get zero-copy access to the buffered PCM frames of a receiver created with pull_enabled.
+ *
+ * Blocks until at least one frame is available or the timeout expires. The returned region is contiguous
+ * and stays valid until it is released with vban_receiver_release(); the receiver keeps appending behind it.
+ * The pull ring is DMA-capable and cache-line aligned. Frames written by the CPU may still be in its cache: a DMA
+ * engine reading the region directly needs it written back first (esp_cache_msync()).
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param[out] data Pointer to the first buffered frame.
+ * @param[out] frames Number of contiguous frames available at data.
+ * @param timeout_ms Maximum time to wait in milliseconds (VBAN_WAIT_FOREVER to wait indefinitely, 0 to poll).
+ * @return
+ * - ESP_OK: At least one frame is available
+ * - ESP_ERR_TIMEOUT: No frame became available in time (*frames is 0)
+ * - ESP_ERR_VBAN_INVALID_STATE: The receiver was not created with pull_enabled, or it is not running and no frame is
+ *   buffered (as in vban_receiver_read(); *frames is 0)
+ * - Others: Error
+ */
+esp_err_t vban_receiver_peek(vban_handle_t handle, const void** data, size_t* frames, uint32_t timeout_ms);
+
+/**
+ * @brief Release frames obtained with vban_receiver_peek().
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param frames Number of frames consumed (at most the number returned by the last peek).
+ * @return ESP_OK on success, or an error code on failure.
+ */
+esp_err_t vban_receiver_release(vban_handle_t handle, size_t frames);
+
+/**
+ * @brief Get the format of the PCM pulled from a receiver created with pull_enabled.
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param[out] format The receiver's pull_format.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_VBAN_INVALID_ARG: NULL format
+ * - ESP_ERR_VBAN_INVALID_STATE: The receiver was not created with pull_enabled
+ * - Others: Error
+ */
+esp_err_t vban_receiver_get_pull_format(vban_handle_t handle, vban_audio_format_t* format);
+
+/**
+ * @brief Get the levels of the PCM written to the pull ring of a receiver created with metering_enabled.
+ *
+ * Peak and RMS cover the last VBAN_LEVEL_WINDOW_MS window, on a 16-bit scale whatever the sample type
+ * (LEVEL_METER_FULL_SCALE is 0 dBFS); clips count the samples at full scale since the receiver was created.
+ * The levels are a by-product of the conversion loop and are published by the receiving task; this call reads
+ * the last published snapshot without locking and never blocks the receiver.
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param[out] levels Receives the levels.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_VBAN_INVALID_ARG: NULL levels
+ * - ESP_ERR_VBAN_INVALID_STATE: The receiver was not created with metering_enabled
+ * - Others: Error
+ */
+esp_err_t vban_receiver_get_levels(vban_handle_t handle, level_meter_levels_t* levels);
+
+/**
+ * @brief Check whether the silence gate of a receiver (silence_gate_ms) is idle.
+ *
+ * The gate goes idle after silence_gate_ms of silent packets; the last of them is ramped down to zero in the pull
+ * ring, and the following silent packets are dropped before conversion, so the ring runs dry and the reader can
+ * power down its output (e.g. mute the amplifier once a peek times out while idle). The first packet above the
+ * threshold re-opens the gate and is converted whole, so no onset is lost.
+ *
+ * @param handle Handle to the VBAN receiver instance.
+ * @param[out] idle true while the gate is idle.
+ * @return
+ * - ESP_OK: Success
+ * - ESP_ERR_VBAN_INVALID_ARG: NULL idle
+ * - ESP_ERR_VBAN_INVALID_STATE: The receiver was not created with a silence gate
+ * - Others: Error
+ */
+esp_err_t vban_receiver_get_idle(vban_handle_t handle, bool* idle);
+
 // --- Utility Functions (can be made static in .c if not needed externally) ---
 
 /**
@@ -284,6 +741,15 @@ uint32_t vban_get_sr_from_index(vban_sample_rate_index_t sr_idx);
  */
 vban_sample_rate_index_t vban_get_index_from_sr(uint32_t sample_rate);
 
+/**
+ * @brief Get the name of the parity stream that accompanies a stream when FEC is enabled.
+ * The stream name is truncated so that the name plus VBAN_FEC_STREAM_SUFFIX fits VBAN_STREAM_NAME_MAX_LEN - 1.
+ *
+ * @param stream_name Name of the audio stream.
+ * @param[out] fec_stream_name Parity stream name, zero padded to VBAN_STREAM_NAME_MAX_LEN bytes.
+ */
+void vban_fec_get_stream_name(const char* stream_name, char fec_stream_name[VBAN_STREAM_NAME_MAX_LEN]);
+
 #ifdef __cplusplus
 }
 #endif